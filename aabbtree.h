@@ -0,0 +1,291 @@
+#ifndef AABBTREE_H
+#define AABBTREE_H
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include "physics.h"
+
+// * =====================================
+// * Dynamic AABB Tree
+// * =====================================
+
+// ? A binary tree of bounding boxes for colliders that move. Each leaf stores a "fat" box: the collider's bounds grown by a
+// ?  margin and stretched in the direction it is moving. While the collider stays inside its fat box, moving it costs one
+// ?  containment check. Only when it leaves is the leaf taken out and reinserted, refitting the boxes above it.
+// ? Leaves are inserted next to the node whose box grows the least, which keeps nearby colliders together so a query only
+// ?  visits the branches whose boxes it overlaps.
+// ? Inserts alone can still build a lopsided tree, e.g. from colliders added in a line, so every node above a changed leaf
+// ?  is rebalanced with an AVL style rotation. That keeps the tree about log2(n) levels deep, which bounds a query's stack.
+// ? Nodes live in one array with a free list, so the tree only allocates when it grows past its largest size so far.
+
+namespace Physics {
+    class AABBTree {
+        public:
+            static const int32_t NONE = -1;
+            static const int32_t MAX_HEIGHT = 63; // tallest tree a query can walk.
+
+        private:
+            struct Node {
+                AABB box; // fat box for leaves, union of the children otherwise.
+                int32_t parent = NONE;
+                int32_t left = NONE; // also the next free node when the node is unused.
+                int32_t right = NONE;
+                uint32_t data = 0; // user data of a leaf.
+                int32_t height = 0; // levels below the node, 0 for leaves.
+
+                inline bool isLeaf() const { return left == NONE; };
+            };
+
+            std::vector<Node> nodes;
+            int32_t root = NONE;
+            int32_t freeList = NONE;
+            float margin;
+
+            static constexpr AABB merge(AABB const &a, AABB const &b) {
+                ZMath::Vec2D minA = a.getMin(), maxA = a.getMax(), minB = b.getMin(), maxB = b.getMax();
+                return AABB(ZMath::Vec2D(ZMath::min(minA.x, minB.x), ZMath::min(minA.y, minB.y)),
+                            ZMath::Vec2D(ZMath::max(maxA.x, maxB.x), ZMath::max(maxA.y, maxB.y)));
+            };
+
+            static constexpr float perimeter(AABB const &a) { return 4.0f*(a.getHalfsize().x + a.getHalfsize().y); };
+
+            static constexpr bool contains(AABB const &outer, AABB const &inner) {
+                ZMath::Vec2D minO = outer.getMin(), maxO = outer.getMax(), minI = inner.getMin(), maxI = inner.getMax();
+                return minO.x <= minI.x && minO.y <= minI.y && maxI.x <= maxO.x && maxI.y <= maxO.y;
+            };
+
+            static constexpr bool overlaps(AABB const &a, AABB const &b) {
+                ZMath::Vec2D minA = a.getMin(), maxA = a.getMax(), minB = b.getMin(), maxB = b.getMax();
+                return minA.x <= maxB.x && minB.x <= maxA.x && minA.y <= maxB.y && minB.y <= maxA.y;
+            };
+
+            int32_t allocNode() {
+                if (freeList == NONE) {
+                    nodes.emplace_back();
+                    return (int32_t) nodes.size() - 1;
+                }
+
+                int32_t id = freeList;
+                freeList = nodes[id].left;
+                nodes[id] = Node();
+                return id;
+            };
+
+            void freeNode(int32_t id) {
+                nodes[id].left = freeList;
+                freeList = id;
+            };
+
+            // Put a node in place of another under the other's parent.
+            inline void replaceChild(int32_t parent, int32_t oldChild, int32_t newChild) {
+                nodes[newChild].parent = parent;
+
+                if (parent == NONE) { root = newChild; }
+                else if (nodes[parent].left == oldChild) { nodes[parent].left = newChild; }
+                else { nodes[parent].right = newChild; }
+            };
+
+            inline void fit(int32_t id) {
+                Node &n = nodes[id];
+                n.box = merge(nodes[n.left].box, nodes[n.right].box);
+                n.height = 1 + ZMath::max(nodes[n.left].height, nodes[n.right].height);
+            };
+
+            // Rotate the taller child of a node above it if its children's heights differ by more than one.
+            // Returns the node now in its place.
+            int32_t balance(int32_t a) {
+                if (nodes[a].isLeaf() || nodes[a].height < 2) { return a; }
+
+                int32_t left = nodes[a].left, right = nodes[a].right;
+                int32_t diff = nodes[right].height - nodes[left].height;
+                if (diff >= -1 && diff <= 1) { return a; }
+
+                // the taller child c takes a's place, a takes c's shorter child, and c keeps its taller one
+                int32_t c = diff > 0 ? right : left;
+                bool leftTaller = nodes[nodes[c].left].height >= nodes[nodes[c].right].height;
+                int32_t taller = leftTaller ? nodes[c].left : nodes[c].right, shorter = leftTaller ? nodes[c].right : nodes[c].left;
+
+                replaceChild(nodes[a].parent, a, c);
+
+                if (diff > 0) { nodes[a].right = shorter; }
+                else { nodes[a].left = shorter; }
+
+                nodes[shorter].parent = a;
+                nodes[c].left = a;
+                nodes[c].right = taller;
+                nodes[a].parent = c;
+
+                fit(a);
+                fit(c);
+                return c;
+            };
+
+            // Rebalance and grow the boxes from a node up to the root to fit their children again.
+            void refit(int32_t id) {
+                for (; id != NONE; id = nodes[id].parent) {
+                    id = balance(id);
+                    fit(id);
+                }
+            };
+
+            void insertLeaf(int32_t leaf) {
+                if (root == NONE) {
+                    root = leaf;
+                    nodes[leaf].parent = NONE;
+                    return;
+                }
+
+                // walk down towards the child whose box grows the least, stopping when pairing here is cheaper than descending
+                AABB const box = nodes[leaf].box;
+                int32_t sibling = root;
+
+                while (!nodes[sibling].isLeaf()) {
+                    Node const &n = nodes[sibling];
+                    float area = perimeter(n.box), combined = perimeter(merge(n.box, box));
+
+                    float cost = 2.0f*combined; // pair with this node
+                    float inherit = 2.0f*(combined - area); // growth every node below here pays
+
+                    float costLeft = perimeter(merge(nodes[n.left].box, box)) + inherit;
+                    if (!nodes[n.left].isLeaf()) { costLeft -= perimeter(nodes[n.left].box); }
+
+                    float costRight = perimeter(merge(nodes[n.right].box, box)) + inherit;
+                    if (!nodes[n.right].isLeaf()) { costRight -= perimeter(nodes[n.right].box); }
+
+                    if (cost < costLeft && cost < costRight) { break; }
+                    sibling = costLeft < costRight ? n.left : n.right;
+                }
+
+                int32_t oldParent = nodes[sibling].parent;
+                int32_t parent = allocNode(); // may move the nodes, so no references are held across it
+
+                nodes[parent].left = sibling;
+                nodes[parent].right = leaf;
+                replaceChild(oldParent, sibling, parent);
+                nodes[sibling].parent = parent;
+                nodes[leaf].parent = parent;
+                fit(parent);
+
+                refit(oldParent);
+            };
+
+            void removeLeaf(int32_t leaf) {
+                if (leaf == root) {
+                    root = NONE;
+                    return;
+                }
+
+                int32_t parent = nodes[leaf].parent;
+                int32_t grandParent = nodes[parent].parent;
+                int32_t sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+                replaceChild(grandParent, parent, sibling);
+                refit(grandParent);
+
+                freeNode(parent);
+            };
+
+            // Grow a box by the margin and stretch it along the displacement expected before the next move.
+            inline AABB fatten(AABB const &box, ZMath::Vec2D const &displacement) const {
+                ZMath::Vec2D min = box.getMin() - ZMath::Vec2D(margin, margin), max = box.getMax() + ZMath::Vec2D(margin, margin);
+
+                if (displacement.x < 0.0f) { min.x += displacement.x; } else { max.x += displacement.x; }
+                if (displacement.y < 0.0f) { min.y += displacement.y; } else { max.y += displacement.y; }
+
+                return AABB(min, max);
+            };
+
+        public:
+            /**
+             * @brief Create an empty tree.
+             *
+             * @param margin Distance the fat boxes extend past the colliders' bounds on every side.
+             */
+            AABBTree(float margin = 4.0f) : margin(margin) {};
+
+            // * Reserve room for n colliders so inserting up to n does not allocate.
+            inline void reserve(size_t n) { nodes.reserve(n ? 2*n - 1 : 0); };
+
+            // * Remove every collider.
+            inline void clear() {
+                nodes.clear();
+                root = NONE;
+                freeList = NONE;
+            };
+
+            /**
+             * @brief Add a collider.
+             *
+             * @param box Bounds of the collider.
+             * @param data Value passed back by queries.
+             * @return Id of the collider's leaf, used to move or remove it.
+             */
+            int32_t insert(AABB const &box, uint32_t data) {
+                int32_t leaf = allocNode();
+                nodes[leaf].box = fatten(box, ZMath::Vec2D());
+                nodes[leaf].data = data;
+
+                insertLeaf(leaf);
+                return leaf;
+            };
+
+            // * Remove a collider.
+            void remove(int32_t leaf) {
+                removeLeaf(leaf);
+                freeNode(leaf);
+            };
+
+            /**
+             * @brief Update the bounds of a collider that moved.
+             *
+             * @param leaf Id returned by insert().
+             * @param box New bounds of the collider.
+             * @param displacement How far the collider moved since the last call, used to predict where it goes next.
+             * @return 1 if the leaf had to be reinserted, 0 if it still fit in its fat box.
+             */
+            bool move(int32_t leaf, AABB const &box, ZMath::Vec2D const &displacement) {
+                if (contains(nodes[leaf].box, box)) { return 0; }
+
+                removeLeaf(leaf);
+                nodes[leaf].box = fatten(box, displacement*2.0f);
+                insertLeaf(leaf);
+                return 1;
+            };
+
+            // * Fat box of a collider.
+            inline AABB const& fatBox(int32_t leaf) const { return nodes[leaf].box; };
+
+            /**
+             * @brief Call fn(data) for every collider whose fat box overlaps a box.
+             *
+             * @param box Box to query.
+             * @param fn Called with the user data of each overlapping collider. It must not change the tree.
+             */
+            template <typename Fn>
+            void query(AABB const &box, Fn const &fn) const {
+                if (root == NONE) { return; }
+
+                // A depth first walk holds at most one node per level plus one, and rebalancing keeps the tree far shallower
+                //  than MAX_HEIGHT, so a fixed stack keeps queries from allocating.
+                int32_t stack[MAX_HEIGHT + 1];
+                int top = 0;
+                stack[top++] = root;
+
+                assert(nodes[root].height <= MAX_HEIGHT);
+
+                while (top) {
+                    Node const &n = nodes[stack[--top]];
+                    if (!overlaps(n.box, box)) { continue; }
+
+                    if (n.isLeaf()) { fn(n.data); }
+                    else {
+                        stack[top++] = n.left;
+                        stack[top++] = n.right;
+                    }
+                }
+            };
+    };
+}
+
+#endif // !AABBTREE_H
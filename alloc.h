@@ -0,0 +1,92 @@
+#ifndef ALLOC_H
+#define ALLOC_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// * ======================================
+// * Allocation Counting
+// * ======================================
+
+// ? Replaces the global operator new/delete so every heap allocation made through C++ is counted.
+// ? Counters are per thread so background work (trace writer, loaders) does not show up as main loop traffic.
+// ? Note: replacement allocation functions cannot be inline, so this header must only be included by one translation unit.
+
+namespace Alloc {
+    struct Counters {
+        uint64_t allocs = 0; // number of allocations made by this thread
+        uint64_t bytes = 0; // number of bytes requested by this thread
+    };
+
+    inline Counters& local() {
+        thread_local Counters c;
+        return c;
+    };
+
+    // * Number of allocations made so far by the calling thread.
+    inline uint64_t count() { return local().allocs; };
+
+    // * Number of bytes requested so far by the calling thread.
+    inline uint64_t bytes() { return local().bytes; };
+
+    inline void* allocate(std::size_t size) {
+        Counters &c = local();
+        c.allocs++;
+        c.bytes += size;
+
+        void* p = std::malloc(size ? size : 1);
+        if (!p) { throw std::bad_alloc(); }
+        return p;
+    };
+
+    inline void* allocateAligned(std::size_t size, std::align_val_t al) {
+        Counters &c = local();
+        c.allocs++;
+        c.bytes += size;
+
+        std::size_t align = static_cast<std::size_t>(al);
+        std::size_t rounded = (size + align - 1) & ~(align - 1);
+
+        #ifdef _WIN32
+            void* p = _aligned_malloc(rounded ? rounded : align, align);
+        #else
+            void* p = std::aligned_alloc(align, rounded ? rounded : align);
+        #endif
+
+        if (!p) { throw std::bad_alloc(); }
+        return p;
+    };
+
+    inline void freeAligned(void* p) {
+        #ifdef _WIN32
+            _aligned_free(p);
+        #else
+            std::free(p);
+        #endif
+    };
+}
+
+void* operator new(std::size_t size) { return Alloc::allocate(size); };
+void* operator new[](std::size_t size) { return Alloc::allocate(size); };
+void* operator new(std::size_t size, std::align_val_t al) { return Alloc::allocateAligned(size, al); };
+void* operator new[](std::size_t size, std::align_val_t al) { return Alloc::allocateAligned(size, al); };
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try { return Alloc::allocate(size); } catch (...) { return nullptr; }
+};
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try { return Alloc::allocate(size); } catch (...) { return nullptr; }
+};
+
+void operator delete(void* p) noexcept { std::free(p); };
+void operator delete[](void* p) noexcept { std::free(p); };
+void operator delete(void* p, std::size_t) noexcept { std::free(p); };
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); };
+void operator delete(void* p, std::align_val_t) noexcept { Alloc::freeAligned(p); };
+void operator delete[](void* p, std::align_val_t) noexcept { Alloc::freeAligned(p); };
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { Alloc::freeAligned(p); };
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { Alloc::freeAligned(p); };
+
+#endif // !ALLOC_H
@@ -0,0 +1,364 @@
+#ifndef ANALYZER_H
+#define ANALYZER_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "parallel.h"
+#include "rng.h"
+#include "simcache.h"
+#include "trickshot.h"
+
+// * =====================================
+// * Monte Carlo Map Difficulty Analyser
+// * =====================================
+
+// ? From every tile the ball can rest on, shots are fired over a grid of aim and strength bins, several jittered shots
+// ?  per bin to model imprecise execution, and each one is simulated with the game's own physics step.
+// ? Each shot lands on a tile, sinks, or ends in the water (which returns the ball to the start like in the game).
+// ? Expected strokes assume a player who picks the best bin every stroke but cannot control where in the bin the shot goes:
+// ?  E(t) = 1 + min over bins of the mean of E(landing tile), with E(sunk) = 0. Only bins from which the hole is still
+// ?  reached with certainty are considered, so tiles without any such bin are reported as unreachable.
+// ? Water and sink probabilities are over all shots fired from the tile.
+// ? Each tile gets its own generator split from the seed, so results do not depend on the number of threads.
+
+namespace Analyzer {
+    struct Options {
+        uint angles = 32; // aim directions sampled.
+        uint powers = 8; // shot strengths sampled.
+        uint samples = 8; // jittered shots per aim and strength bin.
+        float minPower = 24.0f; // weakest shot in pixels dragged. The game ignores drags shorter than sqrt(550).
+        float maxPower = 1200.0f; // strongest shot in pixels dragged.
+        float timeStep = 0.0167f; // same step as the game loop.
+        uint maxSteps = 3600; // a shot still moving after this many steps is stopped where it is.
+        unsigned int threads = 0; // 0 uses every hardware thread.
+        uint64_t seed = 1;
+
+        // Optional cache of shot results. Shots then use the cache's quantised inputs and its time step and step limit.
+        SimCache::Cache* cache = nullptr;
+    };
+
+    struct TileResult {
+        bool playable = 0; // can the ball rest here (not a wall or water).
+        uint shots = 0;
+        uint sunk = 0;
+        uint water = 0;
+        float expectedStrokes = -1.0f; // -1 if not playable or the hole cannot be reached with certainty.
+    };
+
+    struct Result {
+        uint width = 0;
+        uint height = 0;
+        std::vector<TileResult> tiles; // row major.
+
+        uint64_t shots = 0; // total shots simulated.
+        unsigned int threads = 0; // threads the simulation ran on, after the job system's pool capped the request.
+        double simulateSeconds = 0.0;
+        double solveSeconds = 0.0;
+
+        inline TileResult const& at(uint row, uint col) const { return tiles[row*width + col]; };
+    };
+
+    // Marks a shot that went in the hole.
+    static const uint32_t SUNK = 0xffffffffu;
+
+    inline bool isPlayable(char tile) { return tile != 'w' && tile != 'W'; };
+
+    // Tile a ball came to rest on, or from if it stopped somewhere it cannot be played from.
+    inline uint32_t landingTile(TrickShot::Stage const &stage, ZMath::Vec2D const &pos, uint32_t from) {
+        ZMath::Vec2D local = (pos - stage.getOffset()) * (1.0f/16.0f);
+        if (local.x < 0.0f || local.y < 0.0f) { return from; }
+
+        uint col = (uint) local.x, row = (uint) local.y;
+        if (col >= stage.width || row >= stage.height || !isPlayable(stage.tileAt(row, col))) { return from; }
+
+        return row*stage.width + col;
+    };
+
+    // Fire every shot from one tile and record where each one ends. Returns the number that ended in the water.
+    inline uint simulateTile(TrickShot::Stage const &stage, Options const &opt, uint32_t tile, Random::Rng rng, uint32_t* outcomes) {
+        ZMath::Vec2D start = stage.getOffset() + ZMath::Vec2D((tile % stage.width)*16 + 8.0f, (tile / stage.width)*16 + 8.0f);
+        float angleStep = 2.0f*PI/opt.angles;
+        float powerStep = (opt.maxPower - opt.minPower)/opt.powers;
+        uint water = 0;
+
+        for (uint a = 0; a < opt.angles; ++a) {
+            for (uint p = 0; p < opt.powers; ++p) {
+                for (uint k = 0; k < opt.samples; ++k, ++outcomes) {
+                    float angle = (a + rng.nextFloat()) * angleStep;
+                    float power = opt.minPower + (p + rng.nextFloat()) * powerStep;
+
+                    ZMath::Vec2D shot = ZMath::Vec2D(cosf(angle), sinf(angle)) * power;
+                    SimCache::ShotResult res;
+
+                    if (opt.cache) {
+                        res = opt.cache->simulate(stage, start, shot);
+
+                    } else {
+                        TrickShot::Ball ball = stage.getBall();
+                        ball.hitbox.c = start;
+                        ball.prevPos = start;
+                        ball.vel = shot;
+                        ball.canHit = 1;
+
+                        res.outcome = stage.simulate(ball, opt.timeStep, opt.maxSteps);
+                        res.rest = ball.hitbox.c;
+                    }
+
+                    if (res.outcome == TrickShot::SUNK) { *outcomes = SUNK; continue; }
+                    if (res.outcome == TrickShot::WATER) { water++; }
+
+                    *outcomes = landingTile(stage, res.rest, tile);
+                }
+            }
+        }
+
+        return water;
+    };
+
+    // Solve for the expected strokes from every tile given where each shot landed.
+    inline void solve(Result &result, std::vector<uint32_t> const &outcomes, uint bins, uint samples) {
+        size_t numTiles = result.tiles.size();
+        size_t perTile = (size_t) bins*samples;
+
+        // ? Find the tiles the hole can be reached from with certainty. Start from every playable tile and repeatedly
+        // ?  drop tiles that cannot reach the hole using only bins whose shots all stay inside the remaining set.
+        std::vector<uint8_t> inSet(numTiles), reach(numTiles);
+        for (size_t t = 0; t < numTiles; ++t) { inSet[t] = result.tiles[t].playable; }
+
+        auto safe = [&](size_t t, uint b) {
+            uint32_t const* o = &outcomes[t*perTile + (size_t) b*samples];
+            for (uint k = 0; k < samples; ++k) { if (o[k] != SUNK && !inSet[o[k]]) { return 0; } }
+            return 1;
+        };
+
+        while (1) {
+            std::fill(reach.begin(), reach.end(), 0);
+
+            for (bool changed = 1; changed;) {
+                changed = 0;
+
+                for (size_t t = 0; t < numTiles; ++t) {
+                    if (!inSet[t] || reach[t]) { continue; }
+
+                    for (uint b = 0; b < bins && !reach[t]; ++b) {
+                        if (!safe(t, b)) { continue; }
+
+                        uint32_t const* o = &outcomes[t*perTile + (size_t) b*samples];
+                        for (uint k = 0; k < samples; ++k) {
+                            if (o[k] == SUNK || reach[o[k]]) {
+                                reach[t] = 1;
+                                changed = 1;
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+
+            if (reach == inSet) { break; }
+            inSet = reach;
+        }
+
+        // ? Value iteration over the safe bins. Shots landing back on their own tile are solved for directly,
+        // ?  E_b = (1 + sum of the other landings / n) / (1 - self landings / n), so they do not slow convergence.
+        std::vector<uint8_t> safeBins(perTile ? numTiles*bins : 0);
+        for (size_t t = 0; t < numTiles; ++t) {
+            if (!inSet[t]) { continue; }
+            for (uint b = 0; b < bins; ++b) { safeBins[t*bins + b] = safe(t, b); }
+        }
+
+        std::vector<float> e(numTiles, 0.0f);
+
+        for (uint iter = 0; iter < 10000; ++iter) {
+            float maxDelta = 0.0f;
+
+            for (size_t t = 0; t < numTiles; ++t) {
+                if (!inSet[t]) { continue; }
+
+                float best = INFINITY;
+
+                for (uint b = 0; b < bins; ++b) {
+                    if (!safeBins[t*bins + b]) { continue; }
+
+                    uint32_t const* o = &outcomes[t*perTile + (size_t) b*samples];
+                    float sum = 0.0f;
+                    uint self = 0;
+
+                    for (uint k = 0; k < samples; ++k) {
+                        if (o[k] == t) { self++; }
+                        else if (o[k] != SUNK) { sum += e[o[k]]; }
+                    }
+
+                    if (self == samples) { continue; }
+
+                    float v = (1.0f + sum/samples) / (1.0f - (float) self/samples);
+                    if (v < best) { best = v; }
+                }
+
+                if (std::fabs(best - e[t]) > maxDelta) { maxDelta = std::fabs(best - e[t]); }
+                e[t] = best;
+            }
+
+            if (maxDelta < 1e-4f) { break; }
+        }
+
+        for (size_t t = 0; t < numTiles; ++t) { result.tiles[t].expectedStrokes = inSet[t] ? e[t] : -1.0f; }
+    };
+
+    /**
+     * @brief Analyse a stage. The stage only needs its map loaded (Stage::loadMap), so no window is required.
+     *
+     * @param stage The stage to analyse. It is only read, from several threads at once.
+     * @param opt Sampling options.
+     * @return Per-tile results.
+     */
+    inline Result analyze(TrickShot::Stage const &stage, Options const &opt = Options()) {
+        TRACE_SCOPE("Analyzer::analyze", "analysis");
+
+        Result result;
+        result.width = stage.width;
+        result.height = stage.height;
+        result.tiles.resize((size_t) stage.width*stage.height);
+        result.threads = Parallel::threadsUsed(result.tiles.size(), opt.threads);
+
+        uint bins = opt.angles*opt.powers;
+        size_t perTile = (size_t) bins*opt.samples;
+        std::vector<uint32_t> outcomes(result.tiles.size()*perTile, 0);
+
+        // split a generator per tile up front so each tile's shots are the same whichever thread fires them.
+        Random::Rng root(opt.seed);
+        std::vector<Random::Rng> rngs;
+        rngs.reserve(result.tiles.size());
+
+        for (size_t t = 0; t < result.tiles.size(); ++t) {
+            result.tiles[t].playable = isPlayable(stage.tileAt(t / stage.width, t % stage.width));
+            rngs.push_back(root.split());
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        {
+            TRACE_SCOPE("simulate", "analysis");
+
+            Parallel::forEach(result.tiles.size(), opt.threads, [&](size_t t) {
+                TileResult &tile = result.tiles[t];
+                if (!tile.playable) { return; }
+
+                uint32_t* o = &outcomes[t*perTile];
+                tile.water = simulateTile(stage, opt, (uint32_t) t, rngs[t], o);
+                tile.shots = (uint) perTile;
+                for (size_t i = 0; i < perTile; ++i) { tile.sunk += o[i] == SUNK; }
+            });
+        }
+
+        auto mid = std::chrono::steady_clock::now();
+
+        {
+            TRACE_SCOPE("solve", "analysis");
+            solve(result, outcomes, bins, opt.samples);
+        }
+
+        auto end = std::chrono::steady_clock::now();
+
+        for (TileResult const &tile : result.tiles) { result.shots += tile.shots; }
+        result.simulateSeconds = std::chrono::duration<double>(mid - start).count();
+        result.solveSeconds = std::chrono::duration<double>(end - mid).count();
+
+        return result;
+    };
+
+    // * Write one line per tile: row, column, tile character, expected strokes (-1 if unreachable), water and sink probability.
+    inline bool writeCSV(Result const &result, TrickShot::Stage const &stage, const char* path) {
+        FILE* f = fopen(path, "w");
+        if (!f) { return 0; }
+
+        fprintf(f, "row,col,tile,expected_strokes,water_probability,sink_probability,shots\n");
+
+        for (uint row = 0; row < result.height; ++row) {
+            for (uint col = 0; col < result.width; ++col) {
+                TileResult const &tile = result.at(row, col);
+                char c = stage.tileAt(row, col);
+
+                float shots = tile.shots ? (float) tile.shots : 1.0f;
+                fprintf(f, "%u,%u,%c,%.4f,%.6f,%.6f,%u\n", row, col, c == ',' || c < ' ' ? ' ' : c,
+                        tile.expectedStrokes, tile.water/shots, tile.sunk/shots, tile.shots);
+            }
+        }
+
+        return !fclose(f);
+    };
+
+    // Green (0) through yellow to red (1).
+    inline Color heat(float t) {
+        t = ZMath::clamp(t, 0.0f, 1.0f);
+
+        if (t < 0.5f) {
+            t *= 2.0f;
+            return {(unsigned char) (30 + 200*t), (unsigned char) (160 + 50*t), (unsigned char) (60 - 20*t), 255};
+        }
+
+        t = 2.0f*t - 1.0f;
+        return {(unsigned char) (230 - 30*t), (unsigned char) (210 - 180*t), (unsigned char) (40 - 10*t), 255};
+    };
+
+    /**
+     * @brief Export the results as a PNG with three heatmaps stacked from top to bottom: expected strokes,
+     *        water probability, and sink probability. Green is easy and red is hard in all three; sink probability is
+     *        relative to the best tile on the map. Walls are dark grey, water blue, and unreachable tiles purple.
+     *
+     * @param result Analysis results.
+     * @param stage The analysed stage.
+     * @param path PNG file to write.
+     * @param scale Pixels per tile.
+     * @return Was the file written.
+     */
+    inline bool writePNG(Result const &result, TrickShot::Stage const &stage, const char* path, int scale = 8) {
+        float minE = INFINITY, maxE = 0.0f, maxSink = 0.0f;
+
+        for (TileResult const &tile : result.tiles) {
+            if (tile.expectedStrokes >= 0.0f) {
+                minE = ZMath::min(minE, tile.expectedStrokes);
+                maxE = ZMath::max(maxE, tile.expectedStrokes);
+            }
+
+            if (tile.shots) { maxSink = ZMath::max(maxSink, (float) tile.sunk/tile.shots); }
+        }
+
+        int panelW = result.width*scale, panelH = result.height*scale, gap = scale;
+        Image image = GenImageColor(panelW, 3*panelH + 2*gap, BLACK);
+
+        for (uint row = 0; row < result.height; ++row) {
+            for (uint col = 0; col < result.width; ++col) {
+                TileResult const &tile = result.at(row, col);
+                Color colors[3];
+
+                if (!tile.playable) {
+                    Color c = stage.tileAt(row, col) == 'W' ? Color{20, 50, 120, 255} : Color{50, 50, 50, 255};
+                    colors[0] = colors[1] = colors[2] = c;
+
+                } else {
+                    float water = (float) tile.water/tile.shots, sink = (float) tile.sunk/tile.shots;
+
+                    colors[0] = tile.expectedStrokes < 0.0f ? Color{130, 40, 150, 255}
+                                : heat(maxE > minE ? (tile.expectedStrokes - minE)/(maxE - minE) : 0.0f);
+                    colors[1] = heat(water);
+                    colors[2] = heat(maxSink > 0.0f ? 1.0f - sink/maxSink : 1.0f);
+                }
+
+                for (int p = 0; p < 3; ++p) {
+                    ImageDrawRectangle(&image, col*scale, p*(panelH + gap) + row*scale, scale, scale, colors[p]);
+                }
+            }
+        }
+
+        bool ok = ExportImage(image, path);
+        UnloadImage(image);
+
+        return ok;
+    };
+}
+
+#endif // !ANALYZER_H
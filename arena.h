@@ -0,0 +1,157 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+// * ======================================
+// * Linear (Bump) Arena Allocator
+// * ======================================
+
+// ? Allocation is a pointer bump and freeing individual allocations does nothing; everything is released at once by reset().
+// ? The frame arena is reset once per frame after EndDrawing, so it suits temporaries that only live for one frame.
+// ? If a frame needs more than the arena holds, extra blocks are taken from the heap and, at the next reset, merged into
+// ?  one block big enough for that frame, so steady-state frames never touch the heap.
+// ? With ARENA_POISON defined (the default unless NDEBUG is defined) reset() fills released memory with 0xDD, so data
+// ?  read after a reset is obviously garbage rather than silently stale.
+
+#if !defined(ARENA_POISON) && !defined(NDEBUG)
+    #define ARENA_POISON
+#endif
+
+namespace Arena {
+    static const unsigned char POISON = 0xdd;
+
+    class Linear {
+        private:
+            char* block = nullptr;
+            size_t capacity = 0;
+            size_t offset = 0;
+
+            std::vector<std::pair<char*, size_t>> overflow; // extra blocks used this frame.
+            size_t overflowBytes = 0;
+            size_t highWater = 0; // most bytes used in one frame.
+
+            static char* allocBlock(size_t size) { return static_cast<char*>(::operator new(size, std::align_val_t(alignof(std::max_align_t)))); };
+            static void freeBlock(char* p) { ::operator delete(p, std::align_val_t(alignof(std::max_align_t))); };
+
+        public:
+            /**
+             * @brief Create an arena.
+             *
+             * @param bytes Size of the initial block. It grows at a reset if a frame needed more.
+             */
+            Linear(size_t bytes = 256u << 10) : capacity(bytes) { block = allocBlock(capacity); };
+
+            Linear(Linear const &) = delete;
+            Linear& operator = (Linear const &) = delete;
+
+            ~Linear() {
+                for (auto &b : overflow) { freeBlock(b.first); }
+                freeBlock(block);
+            };
+
+            /**
+             * @brief Allocate memory valid until the next reset().
+             *
+             * @param size Bytes to allocate.
+             * @param align Alignment. Must be a power of two no larger than alignof(std::max_align_t).
+             */
+            void* allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+                size_t start = (offset + align - 1) & ~(align - 1);
+
+                if (start + size <= capacity) {
+                    offset = start + size;
+                    return block + start;
+                }
+
+                // out of room: take a block of exactly this size from the heap until the next reset
+                char* p = allocBlock(size ? size : 1);
+                overflow.push_back({p, size});
+                overflowBytes += size + align;
+                return p;
+            };
+
+            // * Release everything allocated since the last reset.
+            void reset() {
+                size_t used = offset + overflowBytes;
+                if (used > highWater) { highWater = used; }
+
+                #ifdef ARENA_POISON
+                    memset(block, POISON, offset);
+                    for (auto &b : overflow) { memset(b.first, POISON, b.second); }
+                #endif
+
+                if (!overflow.empty()) {
+                    for (auto &b : overflow) { freeBlock(b.first); }
+                    overflow.clear();
+
+                    // grow so a frame like this one fits in the block next time
+                    freeBlock(block);
+                    capacity = used + used/2;
+                    block = allocBlock(capacity);
+
+                    #ifdef ARENA_POISON
+                        memset(block, POISON, capacity);
+                    #endif
+                }
+
+                offset = 0;
+                overflowBytes = 0;
+            };
+
+            // * Bytes used since the last reset.
+            inline size_t used() const { return offset + overflowBytes; };
+
+            // * Most bytes used between two resets so far.
+            inline size_t peak() const { return highWater > used() ? highWater : used(); };
+
+            // * Size of the main block.
+            inline size_t size() const { return capacity; };
+
+            // * Does a pointer point into the arena's main block.
+            inline bool owns(void const* p) const { return p >= block && p < block + capacity; };
+    };
+
+    // * The frame arena, reset by the main loop after EndDrawing. Main thread only.
+    inline Linear& frame() {
+        static Linear arena;
+        return arena;
+    };
+
+    // * STL allocator that takes memory from an arena. Deallocation is a no-op.
+    template <typename T>
+    class Allocator {
+        public:
+            typedef T value_type;
+
+            Linear* arena;
+
+            Allocator() : arena(&frame()) {};
+            Allocator(Linear &arena) : arena(&arena) {};
+
+            template <typename U>
+            Allocator(Allocator<U> const &other) : arena(other.arena) {};
+
+            inline T* allocate(size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); };
+            inline void deallocate(T*, size_t) {};
+
+            template <typename U>
+            inline bool operator == (Allocator<U> const &other) const { return arena == other.arena; };
+
+            template <typename U>
+            inline bool operator != (Allocator<U> const &other) const { return arena != other.arena; };
+    };
+
+    // * Containers for per-frame temporaries. They must not outlive the frame.
+    typedef std::basic_string<char, std::char_traits<char>, Allocator<char>> String;
+
+    template <typename T>
+    using Vector = std::vector<T, Allocator<T>>;
+}
+
+#endif // !ARENA_H
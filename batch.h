@@ -0,0 +1,287 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "dispatch.h"
+#include "physics.h"
+
+// * =====================================
+// * Batched Collision Kernels
+// * =====================================
+
+// ? Test one circle or ray against many colliders, or many rays against one collider, stored as structures of arrays.
+// ? Each kernel is compiled for every SIMD level in dispatch.h and gives exactly the same result as calling the
+// ?  matching function in physics.h on each collider or ray in turn.
+
+namespace Physics {
+    // * A set of AABBs stored as separate min and max component arrays.
+    class AABBSet {
+        private:
+            std::vector<float> minX, minY, maxX, maxY;
+
+        public:
+            AABBSet() = default;
+
+            // * Copy n AABBs into a new set.
+            AABBSet(AABB const* aabbs, size_t n) {
+                reserve(n);
+                for (size_t i = 0; i < n; ++i) { push(aabbs[i]); }
+            };
+
+            inline void push(AABB const &a) {
+                ZMath::Vec2D min = a.getMin(), max = a.getMax();
+
+                minX.push_back(min.x);
+                minY.push_back(min.y);
+                maxX.push_back(max.x);
+                maxY.push_back(max.y);
+            };
+
+            inline void reserve(size_t n) {
+                minX.reserve(n);
+                minY.reserve(n);
+                maxX.reserve(n);
+                maxY.reserve(n);
+            };
+
+            inline void clear() {
+                minX.clear();
+                minY.clear();
+                maxX.clear();
+                maxY.clear();
+            };
+
+            inline size_t size() const { return minX.size(); };
+
+            inline float const* minXData() const { return minX.data(); };
+            inline float const* minYData() const { return minY.data(); };
+            inline float const* maxXData() const { return maxX.data(); };
+            inline float const* maxYData() const { return maxY.data(); };
+    };
+
+    // * A set of circles stored as separate center and radius arrays.
+    class CircleSet {
+        private:
+            std::vector<float> xs, ys, rs;
+
+        public:
+            CircleSet() = default;
+
+            // * Copy n circles into a new set.
+            CircleSet(Circle const* circles, size_t n) {
+                reserve(n);
+                for (size_t i = 0; i < n; ++i) { push(circles[i]); }
+            };
+
+            inline void push(Circle const &c) {
+                xs.push_back(c.c.x);
+                ys.push_back(c.c.y);
+                rs.push_back(c.r);
+            };
+
+            inline void reserve(size_t n) {
+                xs.reserve(n);
+                ys.reserve(n);
+                rs.reserve(n);
+            };
+
+            inline void clear() {
+                xs.clear();
+                ys.clear();
+                rs.clear();
+            };
+
+            inline size_t size() const { return xs.size(); };
+
+            inline float const* xData() const { return xs.data(); };
+            inline float const* yData() const { return ys.data(); };
+            inline float const* rData() const { return rs.data(); };
+    };
+
+    // * A set of rays stored as separate origin and direction component arrays.
+    class RaySet {
+        private:
+            std::vector<float> ox, oy, dx, dy;
+
+        public:
+            RaySet() = default;
+
+            // * Copy n rays into a new set.
+            RaySet(Ray2D const* rays, size_t n) {
+                reserve(n);
+                for (size_t i = 0; i < n; ++i) { push(rays[i]); }
+            };
+
+            inline void push(Ray2D const &ray) {
+                ox.push_back(ray.origin.x);
+                oy.push_back(ray.origin.y);
+                dx.push_back(ray.dir.x);
+                dy.push_back(ray.dir.y);
+            };
+
+            inline void reserve(size_t n) {
+                ox.reserve(n);
+                oy.reserve(n);
+                dx.reserve(n);
+                dy.reserve(n);
+            };
+
+            inline void clear() {
+                ox.clear();
+                oy.clear();
+                dx.clear();
+                dy.clear();
+            };
+
+            inline size_t size() const { return ox.size(); };
+
+            inline float const* originXData() const { return ox.data(); };
+            inline float const* originYData() const { return oy.data(); };
+            inline float const* dirXData() const { return dx.data(); };
+            inline float const* dirYData() const { return dy.data(); };
+    };
+
+    namespace Detail {
+        // Same arithmetic as CircleAndAABB.
+        ZMATH_INLINE size_t circleVsAABBsLoop(Circle c, float const* minX, float const* minY, float const* maxX,
+                                              float const* maxY, uint8_t* hits, size_t n) {
+            float r2 = c.r*c.r;
+            size_t count = 0;
+
+            for (size_t i = 0; i < n; ++i) {
+                float dx = ZMath::clamp(c.c.x, minX[i], maxX[i]) - c.c.x;
+                float dy = ZMath::clamp(c.c.y, minY[i], maxY[i]) - c.c.y;
+
+                uint8_t hit = dx*dx + dy*dy <= r2;
+                hits[i] = hit;
+                count += hit;
+            }
+
+            return count;
+        };
+
+        // Same arithmetic as CircleAndCircle.
+        ZMATH_INLINE size_t circleVsCirclesLoop(Circle c, float const* xs, float const* ys, float const* rs, uint8_t* hits, size_t n) {
+            size_t count = 0;
+
+            for (size_t i = 0; i < n; ++i) {
+                float r = c.r + rs[i];
+                float dx = c.c.x - xs[i], dy = c.c.y - ys[i];
+
+                uint8_t hit = dx*dx + dy*dy <= r*r;
+                hits[i] = hit;
+                count += hit;
+            }
+
+            return count;
+        };
+
+        // Same arithmetic as raycast, with its three rejections (box behind the ray, missed, ray starting inside) as masks.
+        ZMATH_INLINE uint8_t slab(float ox, float oy, float fracX, float fracY, float minX, float minY, float maxX, float maxY,
+                                  float &dist, uint8_t &yAxis) {
+            float t1 = (minX - ox)*fracX;
+            float t2 = (maxX - ox)*fracX;
+            float t3 = (minY - oy)*fracY;
+            float t4 = (maxY - oy)*fracY;
+
+            float tMin = ZMath::max(ZMath::min(t1, t2), ZMath::min(t3, t4));
+            float tMax = ZMath::min(ZMath::max(t1, t2), ZMath::max(t3, t4));
+
+            uint8_t hit = !(tMax < 0) & !(tMax < tMin) & !(tMin < 0);
+            dist = hit ? tMin : -1.0f;
+            yAxis = hit & ((tMin == t1) | (tMin == t2));
+
+            return hit;
+        };
+
+        ZMATH_INLINE size_t rayVsAABBsLoop(Ray2D ray, float const* minX, float const* minY, float const* maxX, float const* maxY,
+                                           float* dists, uint8_t* yAxis, size_t n) {
+            float fracX = 1.0f/ray.dir.x, fracY = 1.0f/ray.dir.y;
+            size_t count = 0;
+
+            for (size_t i = 0; i < n; ++i) {
+                count += slab(ray.origin.x, ray.origin.y, fracX, fracY, minX[i], minY[i], maxX[i], maxY[i], dists[i], yAxis[i]);
+            }
+
+            return count;
+        };
+
+        ZMATH_INLINE size_t raysVsAABBLoop(float const* ox, float const* oy, float const* dx, float const* dy, AABB a,
+                                           float* dists, uint8_t* yAxis, size_t n) {
+            ZMath::Vec2D min = a.getMin(), max = a.getMax();
+            size_t count = 0;
+
+            for (size_t i = 0; i < n; ++i) {
+                count += slab(ox[i], oy[i], 1.0f/dx[i], 1.0f/dy[i], min.x, min.y, max.x, max.y, dists[i], yAxis[i]);
+            }
+
+            return count;
+        };
+
+        ZMATH_MULTIVERSION(, size_t, circleVsAABBs, (Circle c, float const* minX, float const* minY, float const* maxX, float const* maxY, uint8_t* hits, size_t n),
+                           (c, minX, minY, maxX, maxY, hits, n), circleVsAABBsLoop)
+
+        ZMATH_MULTIVERSION(, size_t, circleVsCircles, (Circle c, float const* xs, float const* ys, float const* rs, uint8_t* hits, size_t n),
+                           (c, xs, ys, rs, hits, n), circleVsCirclesLoop)
+
+        ZMATH_MULTIVERSION(, size_t, rayVsAABBs, (Ray2D ray, float const* minX, float const* minY, float const* maxX, float const* maxY, float* dists, uint8_t* yAxis, size_t n),
+                           (ray, minX, minY, maxX, maxY, dists, yAxis, n), rayVsAABBsLoop)
+
+        ZMATH_MULTIVERSION(, size_t, raysVsAABB, (float const* ox, float const* oy, float const* dx, float const* dy, AABB a, float* dists, uint8_t* yAxis, size_t n),
+                           (ox, oy, dx, dy, a, dists, yAxis, n), raysVsAABBLoop)
+    }
+
+    /**
+     * @brief Test a circle against every AABB in a set.
+     *
+     * @param c The circle.
+     * @param set The AABBs.
+     * @param hits Set to 1 for each AABB the circle intersects and 0 otherwise. Must hold set.size() entries.
+     * @return The number of AABBs intersected.
+     */
+    inline size_t CircleAndAABBs(Circle const &c, AABBSet const &set, uint8_t* hits) {
+        return ZMATH_DISPATCH_CALL(Detail::circleVsAABBs, c, set.minXData(), set.minYData(), set.maxXData(), set.maxYData(), hits, set.size());
+    };
+
+    /**
+     * @brief Test a circle against every circle in a set.
+     *
+     * @param c The circle.
+     * @param set The other circles.
+     * @param hits Set to 1 for each circle intersected and 0 otherwise. Must hold set.size() entries.
+     * @return The number of circles intersected.
+     */
+    inline size_t CircleAndCircles(Circle const &c, CircleSet const &set, uint8_t* hits) {
+        return ZMATH_DISPATCH_CALL(Detail::circleVsCircles, c, set.xData(), set.yData(), set.rData(), hits, set.size());
+    };
+
+    /**
+     * @brief Cast a ray against every AABB in a set.
+     *
+     * @param ray 2D ray.
+     * @param set The AABBs.
+     * @param dists Set to the distance along the ray to each AABB, or -1 if it is not hit. Must hold set.size() entries.
+     * @param yAxis Set to 1 for each AABB hit on its y-axis and 0 otherwise, as in raycast(). Must hold set.size() entries.
+     * @return The number of AABBs hit.
+     */
+    inline size_t RayAndAABBs(Ray2D const &ray, AABBSet const &set, float* dists, uint8_t* yAxis) {
+        return ZMATH_DISPATCH_CALL(Detail::rayVsAABBs, ray, set.minXData(), set.minYData(), set.maxXData(), set.maxYData(), dists, yAxis, set.size());
+    };
+
+    /**
+     * @brief Cast every ray in a set against an AABB.
+     *
+     * @param set The rays.
+     * @param a The AABB.
+     * @param dists Set to the distance along each ray to the AABB, or -1 if it misses. Must hold set.size() entries.
+     * @param yAxis Set to 1 for each ray hitting the AABB on its y-axis and 0 otherwise, as in raycast(). Must hold set.size() entries.
+     * @return The number of rays that hit.
+     */
+    inline size_t RaysAndAABB(RaySet const &set, AABB const &a, float* dists, uint8_t* yAxis) {
+        return ZMATH_DISPATCH_CALL(Detail::raysVsAABB, set.originXData(), set.originYData(), set.dirXData(), set.dirYData(), a, dists, yAxis, set.size());
+    };
+}
+
+#endif // !BATCH_H
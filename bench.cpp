@@ -0,0 +1,443 @@
+// ? Benchmarks for the math and collision kernels.
+// ? Build with `make bench`, which runs them with the scalar ZMath, the SSE2 backend, and fast-math mode.
+// ? The fast-math accuracy check fails the run if an approximation exceeds its documented error bound, and the
+// ?  dispatch check fails it if any SIMD level of a batched kernel differs from the scalar reference.
+
+#include <bit>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "batch.h"
+#include "physics.h"
+#include "sdf.h"
+#include "vec2array.h"
+
+// Simple deterministic generator so every build benchmarks the same data.
+static uint32_t benchSeed = 12345;
+static float randf(float lo, float hi) {
+    benchSeed = benchSeed * 1664525u + 1013904223u;
+    return lo + (hi - lo) * ((benchSeed >> 8) * (1.0f / 16777216.0f));
+};
+
+// Run fn reps times and print the average time per call in nanoseconds.
+template <typename Fn>
+static void bench(const char* name, int reps, int opsPerRep, Fn fn) {
+    fn(); // warm up
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; ++i) { fn(); }
+    auto end = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    printf("  %-40s %10.3f ns/op\n", name, ns / ((double) reps * opsPerRep));
+};
+
+// Keep the optimizer from discarding results.
+static volatile float sink;
+
+// Largest error of an approximation against a double precision reference over n evenly spaced samples in [lo, hi].
+// The error is relative to the reference when relative is set, otherwise absolute.
+template <typename Approx, typename Ref>
+static double maxError(Approx approx, Ref ref, float lo, float hi, int n, bool relative) {
+    double worst = 0.0;
+
+    for (int i = 0; i <= n; ++i) {
+        float x = lo + (hi - lo) * ((float) i / n);
+        double r = ref((double) x);
+        double err = std::fabs((double) approx(x) - r);
+        if (relative) { err /= std::fabs(r); }
+        if (err > worst) { worst = err; }
+    }
+
+    return worst;
+};
+
+// Print the measured error of an approximation and whether it is within its documented bound.
+static bool checkError(const char* name, double err, double bound) {
+    bool ok = err <= bound;
+    printf("  %-40s %10.3g (bound %.2g)%s\n", name, err, bound, ok ? "" : "  FAIL");
+    return ok;
+};
+
+// Check every ZMath::Fast function against libm. Returns false if any bound is exceeded.
+static bool checkFastMath() {
+    printf("fast-math max error vs double libm:\n");
+
+    // rsqrt and sqrt are checked over every 97th float in the normal range, which covers every exponent.
+    double rsqrtErr = 0.0, sqrtErr = 0.0;
+    for (uint32_t b = 0x00800000u; b < 0x7f000000u; b += 97) {
+        float n = std::bit_cast<float>(b);
+        double r = std::sqrt((double) n);
+
+        rsqrtErr = std::fmax(rsqrtErr, std::fabs(ZMath::Fast::rsqrt(n) * r - 1.0));
+        sqrtErr = std::fmax(sqrtErr, std::fabs(ZMath::Fast::sqrt(n) / r - 1.0));
+    }
+
+    bool ok = checkError("rsqrt (relative)", rsqrtErr, 4.8e-6);
+    ok &= checkError("sqrt (relative)", sqrtErr, 4.8e-6);
+
+    ok &= checkError("sin, |x| <= 1000", maxError(ZMath::Fast::sin, [](double x) { return std::sin(x); }, -1000.0f, 1000.0f, 4000000, 0), 2.3e-7);
+    ok &= checkError("cos, |x| <= 1000", maxError(ZMath::Fast::cos, [](double x) { return std::cos(x); }, -1000.0f, 1000.0f, 4000000, 0), 2.3e-7);
+
+    auto sinRef = [](double d) { return std::sin(std::fmod(d, 360.0) * (M_PI / 180.0)); };
+    auto cosRef = [](double d) { return std::cos(std::fmod(d, 360.0) * (M_PI / 180.0)); };
+    ok &= checkError("sinDeg, |x| <= 36000", maxError(ZMath::Fast::sinDeg, sinRef, -36000.0f, 36000.0f, 4000000, 0), 2.5e-7);
+    ok &= checkError("cosDeg, |x| <= 36000", maxError(ZMath::Fast::cosDeg, cosRef, -36000.0f, 36000.0f, 4000000, 0), 2.5e-7);
+
+    ok &= checkError("acos", maxError(ZMath::Fast::acos, [](double x) { return std::acos(x); }, -1.0f, 1.0f, 4000000, 0), 7.5e-6);
+
+    // for reference, libm's own float functions
+    printf("  %-40s %10.3g\n", "libm sinf, |x| <= 1000", maxError(sinf, [](double x) { return std::sin(x); }, -1000.0f, 1000.0f, 4000000, 0));
+
+    return ok;
+};
+
+// Run every batched kernel at each SIMD level this CPU supports and compare the results bit for bit with the scalar
+// level and with the per-object functions in physics.h. Returns false on any mismatch.
+static bool checkDispatch() {
+    printf("dispatch: detected %s\n", Dispatch::name(Dispatch::detect()));
+
+    static const int n = 1027; // not a multiple of any vector width so the loop tails are covered
+    static Physics::AABB aabbs[n];
+    static Physics::Circle circles[n];
+    static ZMath::Vec2D points[n];
+
+    for (int i = 0; i < n; ++i) {
+        ZMath::Vec2D min(randf(0, 200), randf(0, 200));
+        aabbs[i] = Physics::AABB(min, min + ZMath::Vec2D(randf(0, 16), randf(0, 16)));
+        circles[i] = Physics::Circle(ZMath::Vec2D(randf(0, 200), randf(0, 200)), randf(1, 8));
+        points[i] = ZMath::Vec2D(randf(-100, 100), randf(-100, 100));
+    }
+
+    // exact contacts so the <= comparisons are exercised on equality
+    aabbs[0] = Physics::AABB(ZMath::Vec2D(108.0f, 90.0f), ZMath::Vec2D(120.0f, 110.0f));
+    circles[0] = Physics::Circle(ZMath::Vec2D(92.0f, 100.0f), 4.0f);
+
+    // a box around the start of the ray probes below, and one with a side on the line of the axis aligned probe
+    aabbs[1] = Physics::AABB(ZMath::Vec2D(96.0f, 96.0f), ZMath::Vec2D(104.0f, 104.0f));
+    aabbs[2] = Physics::AABB(ZMath::Vec2D(100.0f, 120.0f), ZMath::Vec2D(110.0f, 130.0f));
+
+    Physics::AABBSet aabbSet(aabbs, n);
+    Physics::CircleSet circleSet(circles, n);
+    ZMath::Vec2Array pointArray(points, n);
+
+    Physics::Circle ball(ZMath::Vec2D(100.0f, 100.0f), 8.0f);
+    ZMath::Mat2D rot = ZMath::Mat2D::rotationMat(17.5f);
+
+    static uint8_t aabbRef[n], circleRef[n], hits[n];
+    for (int i = 0; i < n; ++i) {
+        aabbRef[i] = Physics::CircleAndAABB(ball, aabbs[i]);
+        circleRef[i] = Physics::CircleAndCircle(ball, circles[i]);
+    }
+
+    // Rays for the slab kernels. Besides random ones: a ray starting inside the box (rejected), rays along an axis (an
+    //  infinite reciprocal), one lying on a slab's plane (NaN slab distances), and one through a corner (tied slabs).
+    Physics::AABB box(ZMath::Vec2D(108.0f, 90.0f), ZMath::Vec2D(120.0f, 110.0f));
+    Physics::Ray2D probes[2] = {Physics::Ray2D(ZMath::Vec2D(100.0f, 100.0f), ZMath::Vec2D(0.6f, 0.8f)),
+                                Physics::Ray2D(ZMath::Vec2D(100.0f, 100.0f), ZMath::Vec2D(0.0f, 1.0f))};
+
+    std::vector<Physics::Ray2D> rays;
+    rays.push_back(Physics::Ray2D(ZMath::Vec2D(110.0f, 100.0f), ZMath::Vec2D(1.0f, 0.0f)));
+    rays.push_back(Physics::Ray2D(ZMath::Vec2D(100.0f, 100.0f), ZMath::Vec2D(1.0f, 0.0f)));
+    rays.push_back(Physics::Ray2D(ZMath::Vec2D(100.0f, 90.0f), ZMath::Vec2D(1.0f, 0.0f)));
+    rays.push_back(Physics::Ray2D(ZMath::Vec2D(100.0f, 82.0f), ZMath::Vec2D(0.6f, 0.6f).normalize()));
+
+    while (rays.size() < (size_t) n) {
+        float angle = randf(0, 360);
+        rays.push_back(Physics::Ray2D(ZMath::Vec2D(randf(0, 200), randf(0, 200)), ZMath::Vec2D(cosf(angle), sinf(angle))));
+    }
+
+    Physics::RaySet raySet(rays.data(), n);
+
+    // misses leave the scalar yAxis unset, the kernels set it to 0
+    static float probeDistRef[2][n], rayDistRef[n], dists[n];
+    static uint8_t probeAxisRef[2][n], rayAxisRef[n];
+    for (int i = 0; i < n; ++i) {
+        for (int p = 0; p < 2; ++p) {
+            bool yAxis = 0;
+            probeAxisRef[p][i] = Physics::raycast(probes[p], aabbs[i], probeDistRef[p][i], yAxis) && yAxis;
+        }
+
+        bool yAxis = 0;
+        rayAxisRef[i] = Physics::raycast(rays[i], box, rayDistRef[i], yAxis) && yAxis;
+    }
+
+    Dispatch::force(Dispatch::SCALAR);
+    ZMath::Vec2Array exprRef = ZMath::normalize(rot * pointArray + ZMath::Vec2D(3.0f, -2.0f)) * 0.5f;
+    float sumRef = ZMath::sumDistSq(pointArray, ball.c), minRef = ZMath::minDistSq(pointArray, ball.c);
+
+    bool ok = 1;
+
+    for (int l = Dispatch::SCALAR; l < Dispatch::NUM_LEVELS; ++l) {
+        Dispatch::Level level = (Dispatch::Level) l;
+        if (!Dispatch::supported(level)) {
+            printf("  %-40s not supported by this CPU\n", Dispatch::name(level));
+            continue;
+        }
+
+        Dispatch::force(level);
+        bool match = 1;
+
+        size_t count = Physics::CircleAndAABBs(ball, aabbSet, hits);
+        match &= !memcmp(hits, aabbRef, n) && count == (size_t) std::count(aabbRef, aabbRef + n, 1);
+
+        count = Physics::CircleAndCircles(ball, circleSet, hits);
+        match &= !memcmp(hits, circleRef, n) && count == (size_t) std::count(circleRef, circleRef + n, 1);
+
+        ZMath::Vec2Array expr = ZMath::normalize(rot * pointArray + ZMath::Vec2D(3.0f, -2.0f)) * 0.5f;
+        match &= !memcmp(expr.xData(), exprRef.xData(), n * sizeof(float)) && !memcmp(expr.yData(), exprRef.yData(), n * sizeof(float));
+
+        float sum = ZMath::sumDistSq(pointArray, ball.c), min = ZMath::minDistSq(pointArray, ball.c);
+        match &= !memcmp(&sum, &sumRef, sizeof(float)) && !memcmp(&min, &minRef, sizeof(float));
+
+        for (int p = 0; p < 2; ++p) {
+            count = Physics::RayAndAABBs(probes[p], aabbSet, dists, hits);
+            match &= !memcmp(dists, probeDistRef[p], sizeof(dists)) && !memcmp(hits, probeAxisRef[p], n);
+            match &= count == (size_t) std::count_if(probeDistRef[p], probeDistRef[p] + n, [](float d) { return d != -1.0f; });
+        }
+
+        count = Physics::RaysAndAABB(raySet, box, dists, hits);
+        match &= !memcmp(dists, rayDistRef, sizeof(dists)) && !memcmp(hits, rayAxisRef, n);
+        match &= count == (size_t) std::count_if(rayDistRef, rayDistRef + n, [](float d) { return d != -1.0f; });
+
+        char name[64];
+        bench(Dispatch::name(level), 20000, n, [&] { sink = (float) Physics::CircleAndAABBs(ball, aabbSet, hits); });
+
+        snprintf(name, sizeof(name), "%s: ray vs AABBs", Dispatch::name(level));
+        bench(name, 20000, n, [&] { sink = (float) Physics::RayAndAABBs(probes[0], aabbSet, dists, hits); });
+
+        snprintf(name, sizeof(name), "%s: rays vs AABB", Dispatch::name(level));
+        bench(name, 20000, n, [&] { sink = (float) Physics::RaysAndAABB(raySet, box, dists, hits); });
+        if (!match) { printf("  %-40s FAIL: differs from the scalar reference\n", Dispatch::name(level)); }
+        ok &= match;
+    }
+
+    bench("raycast() per AABB (physics.h)", 20000, n, [&] {
+        float d;
+        bool yAxis;
+        size_t count = 0;
+
+        for (int i = 0; i < n; ++i) { count += Physics::raycast(probes[0], aabbs[i], d, yAxis); }
+        sink = (float) count;
+    });
+
+    Dispatch::force(Dispatch::detect());
+    return ok;
+};
+
+int main() {
+    #ifdef ZMATH_SSE2
+        printf("ZMath backend: SSE2");
+    #else
+        printf("ZMath backend: scalar");
+    #endif
+
+    #ifdef ZMATH_FAST_MATH
+        printf(", fast-math\n");
+    #else
+        printf("\n");
+    #endif
+
+    static const int numBalls = 64;
+    static const int numWalls = 256;
+    static const int numBoxes = 64;
+
+    Physics::Circle balls[numBalls];
+    ZMath::Vec2D vels[numBalls];
+    Physics::AABB walls[numWalls];
+    Physics::Box2D boxes[numBoxes];
+
+    for (int i = 0; i < numBalls; ++i) {
+        balls[i] = Physics::Circle(ZMath::Vec2D(randf(0, 1120), randf(0, 256)), 8.0f);
+        vels[i] = ZMath::Vec2D(randf(-600, 600), randf(-600, 600));
+    }
+
+    for (int i = 0; i < numWalls; ++i) {
+        ZMath::Vec2D min(randf(0, 1100), randf(0, 240));
+        walls[i] = Physics::AABB(min, min + ZMath::Vec2D(randf(16, 64), randf(16, 64)));
+    }
+
+    for (int i = 0; i < numBoxes; ++i) {
+        ZMath::Vec2D min(randf(0, 1100), randf(0, 240));
+        boxes[i] = Physics::Box2D(min, min + ZMath::Vec2D(randf(16, 64), randf(16, 64)), randf(0, 360));
+    }
+
+    printf("collision-heavy steps (%d balls, %d walls, %d rotated boxes):\n", numBalls, numWalls, numBoxes);
+
+    bench("step: circle vs AABB + normal", 200, numBalls * numWalls, [&] {
+        float acc = 0.0f;
+        ZMath::Vec2D n;
+
+        for (int i = 0; i < numBalls; ++i) {
+            for (int j = 0; j < numWalls; ++j) {
+                if (Physics::CircleAndAABB(balls[i], walls[j], n)) { acc += n.x; }
+            }
+
+            balls[i].c += vels[i] * 0.0167f;
+            vels[i] *= 0.98f;
+        }
+
+        sink = acc;
+    });
+
+    bench("step: circle vs Box2D", 200, numBalls * numBoxes, [&] {
+        int hits = 0;
+
+        for (int i = 0; i < numBalls; ++i) {
+            for (int j = 0; j < numBoxes; ++j) { hits += Physics::CircleAndBox2D(balls[i], boxes[j]); }
+        }
+
+        sink = (float) hits;
+    });
+
+    bench("step: circle vs Box2D + normal", 200, numBalls * numBoxes, [&] {
+        float acc = 0.0f;
+        ZMath::Vec2D n;
+        float depth;
+
+        for (int i = 0; i < numBalls; ++i) {
+            for (int j = 0; j < numBoxes; ++j) {
+                if (Physics::CircleAndBox2D(balls[i], boxes[j], n, depth)) { acc += n.x + depth; }
+            }
+        }
+
+        sink = acc;
+    });
+
+    // the same walls and boxes baked into one distance field, which the ball reads once however many there are
+    Physics::SignedDistanceField field;
+    field.build(ZMath::Vec2D(), ZMath::Vec2D(1168, 304), 4.0f, 64.0f, [&](ZMath::Vec2D const &p) {
+        float d = 64.0f;
+        for (int j = 0; j < numWalls; ++j) { d = ZMath::min(d, Physics::SignedDistance(p, Physics::Box2D(walls[j].getMin(), walls[j].getMax(), 0.0f))); }
+        for (int j = 0; j < numBoxes; ++j) { d = ZMath::min(d, Physics::SignedDistance(p, boxes[j])); }
+        return d;
+    });
+
+    bench("step: circle vs distance field + normal", 2000, numBalls, [&] {
+        float acc = 0.0f;
+        ZMath::Vec2D gradient;
+
+        for (int i = 0; i < numBalls; ++i) {
+            float d = field.sample(balls[i].c, gradient);
+            if (d < balls[i].r) { acc += gradient.x + d; }
+        }
+
+        sink = acc;
+    });
+
+    printf("math kernels:\n");
+
+    static const int numVecs = 4096;
+    static ZMath::Vec2D vecs[numVecs], outs[numVecs];
+    static ZMath::Mat2D mats[numVecs];
+
+    for (int i = 0; i < numVecs; ++i) {
+        vecs[i] = ZMath::Vec2D(randf(-100, 100), randf(-100, 100));
+        mats[i] = ZMath::Mat2D(randf(-2, 2), randf(-2, 2), randf(-2, 2), randf(-2, 2));
+    }
+
+    bench("Vec2D::normalize", 2000, numVecs, [&] {
+        for (int i = 0; i < numVecs; ++i) { outs[i] = vecs[i].normalize(); }
+        sink = outs[numVecs - 1].x;
+    });
+
+    bench("Vec2D::distSq", 2000, numVecs, [&] {
+        float acc = 0.0f;
+        for (int i = 1; i < numVecs; ++i) { acc += vecs[i].distSq(vecs[i - 1]); }
+        sink = acc;
+    });
+
+    bench("Mat2D * Vec2D", 2000, numVecs, [&] {
+        for (int i = 0; i < numVecs; ++i) { outs[i] = mats[i] * vecs[i]; }
+        sink = outs[numVecs - 1].x;
+    });
+
+    bench("Mat2D::inverse", 2000, numVecs, [&] {
+        float acc = 0.0f;
+        for (int i = 0; i < numVecs; ++i) { acc += mats[i].inverse().c1.x; }
+        sink = acc;
+    });
+
+    bench("Mat2D::transpose", 2000, numVecs, [&] {
+        float acc = 0.0f;
+        for (int i = 0; i < numVecs; ++i) { acc += mats[i].transpose().c2.x; }
+        sink = acc;
+    });
+
+    bench("Mat2D::rotationMat (whole deg)", 2000, numVecs, [&] {
+        float acc = 0.0f;
+        for (int i = 0; i < numVecs; ++i) { acc += ZMath::Mat2D::rotationMat((float) (i % 360)).c1.y; }
+        sink = acc;
+    });
+
+    bench("Mat2D::rotationMat (fractional)", 2000, numVecs, [&] {
+        float acc = 0.0f;
+        for (int i = 0; i < numVecs; ++i) { acc += ZMath::Mat2D::rotationMat(i * 0.37f).c1.y; }
+        sink = acc;
+    });
+
+    printf("fast-math kernels vs libm:\n");
+
+    bench("sinf + cosf", 2000, numVecs, [&] {
+        for (int i = 0; i < numVecs; ++i) { outs[i] = ZMath::Vec2D(sinf(vecs[i].x), cosf(vecs[i].y)); }
+        sink = outs[numVecs - 1].x;
+    });
+
+    bench("Fast::sin + Fast::cos", 2000, numVecs, [&] {
+        for (int i = 0; i < numVecs; ++i) { outs[i] = ZMath::Vec2D(ZMath::Fast::sin(vecs[i].x), ZMath::Fast::cos(vecs[i].y)); }
+        sink = outs[numVecs - 1].x;
+    });
+
+    bench("acosf", 2000, numVecs, [&] {
+        for (int i = 0; i < numVecs; ++i) { outs[i].x = acosf(vecs[i].x * 0.01f); }
+        sink = outs[numVecs - 1].x;
+    });
+
+    bench("Fast::acos", 2000, numVecs, [&] {
+        for (int i = 0; i < numVecs; ++i) { outs[i].x = ZMath::Fast::acos(vecs[i].x * 0.01f); }
+        sink = outs[numVecs - 1].x;
+    });
+
+    bench("1/sqrtf", 2000, numVecs, [&] {
+        for (int i = 0; i < numVecs; ++i) { outs[i].x = 1.0f/sqrtf(vecs[i].magSq()); }
+        sink = outs[numVecs - 1].x;
+    });
+
+    bench("Fast::rsqrt", 2000, numVecs, [&] {
+        for (int i = 0; i < numVecs; ++i) { outs[i].x = ZMath::Fast::rsqrt(vecs[i].magSq()); }
+        sink = outs[numVecs - 1].x;
+    });
+
+    printf("bulk 2D (%d points): Vec2D loop vs fused Vec2Array\n", numVecs);
+
+    ZMath::Mat2D rot = ZMath::Mat2D::rotationMat(30.0f);
+    ZMath::Vec2D shift(5.0f, -3.0f), lo(-0.5f), hi(0.5f);
+    ZMath::Vec2Array soa(vecs, numVecs), soaOut(numVecs);
+
+    bench("Vec2D: clamp(normalize(R*v + s))", 2000, numVecs, [&] {
+        for (int i = 0; i < numVecs; ++i) { outs[i] = ZMath::clamp((rot * vecs[i] + shift).normalize(), lo, hi); }
+        sink = outs[numVecs - 1].x;
+    });
+
+    bench("Vec2Array: clamp(normalize(R*v + s))", 2000, numVecs, [&] {
+        soaOut = ZMath::clamp(ZMath::normalize(rot * soa + shift), lo, hi);
+        sink = soaOut.x(numVecs - 1);
+    });
+
+    bench("Vec2D: sum of distSq", 2000, numVecs, [&] {
+        float acc = 0.0f;
+        for (int i = 0; i < numVecs; ++i) { acc += vecs[i].distSq(shift); }
+        sink = acc;
+    });
+
+    bench("Vec2Array: sumDistSq", 2000, numVecs, [&] { sink = ZMath::sumDistSq(soa, shift); });
+
+    printf("batched circle and ray vs AABB per SIMD level (%s):\n", "verified against scalar");
+    bool ok = checkDispatch();
+
+    ok &= checkFastMath();
+    return ok ? 0 : 1;
+};
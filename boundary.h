@@ -0,0 +1,197 @@
+#ifndef BOUNDARY_H
+#define BOUNDARY_H
+
+#include <cstdint>
+#include <vector>
+#include "physics.h"
+
+// * =====================================
+// * Exposed Wall Boundary
+// * =====================================
+
+// ? Walls built from touching boxes have seams between them, where the sides of neighbouring boxes are buried in the wall.
+// ?  The outline of the walls has none: its edges are the tile sides between a wall tile and an open tile, merged along
+// ?  each row and column, so a flat wall is one edge however many tiles it spans.
+// ? The outline is built from the tile grid once at load time, and is only used to bake the stage's wall distance field
+// ?  (see sdf.h). Its edges are bucketed in a uniform grid of cells a few tiles across, so the bake only measures the few
+// ?  edges near each sample.
+
+namespace Physics {
+    // * A wall edge facing open space.
+    struct Edge {
+        ZMath::Vec2D a; // start of the edge.
+        ZMath::Vec2D dir; // unit direction from the start to the end.
+        float len; // length of the edge.
+        ZMath::Vec2D normal; // unit normal pointing into open space.
+    };
+
+    // * Distance from a point to the nearest point of an edge.
+    float Distance(ZMath::Vec2D const &p, Edge const &e) {
+        float s = ZMath::clamp(e.dir * (p - e.a), 0.0f, e.len);
+        return (e.a + e.dir*s - p).mag();
+    };
+
+    class Boundary {
+        private:
+            std::vector<Edge> edges;
+
+            // uniform grid of cells listing the edges touching them, stored as one array with an offset per cell
+            ZMath::Vec2D origin;
+            float cellSize = 64.0f;
+            int cols = 0, rows = 0;
+            std::vector<uint32_t> cellStart; // edges of cell i are cellItems[cellStart[i], cellStart[i + 1]).
+            std::vector<uint32_t> cellItems;
+
+            inline int cellX(float x) const { int i = (int) ((x - origin.x)/cellSize); return i < 0 ? 0 : (i >= cols ? cols - 1 : i); };
+            inline int cellY(float y) const { int i = (int) ((y - origin.y)/cellSize); return i < 0 ? 0 : (i >= rows ? rows - 1 : i); };
+
+            // Bounds of an edge, for bucketing and for reporting it once from the first cell it shares with a query.
+            inline ZMath::Vec2D itemMin(uint32_t item) const {
+                Edge const &e = edges[item];
+                return ZMath::Vec2D(ZMath::min(e.a.x, e.a.x + e.dir.x*e.len), ZMath::min(e.a.y, e.a.y + e.dir.y*e.len));
+            };
+
+            inline ZMath::Vec2D itemMax(uint32_t item) const {
+                Edge const &e = edges[item];
+                return ZMath::Vec2D(ZMath::max(e.a.x, e.a.x + e.dir.x*e.len), ZMath::max(e.a.y, e.a.y + e.dir.y*e.len));
+            };
+
+            void addEdge(ZMath::Vec2D const &a, ZMath::Vec2D const &dir, float len, ZMath::Vec2D const &normal) {
+                edges.push_back({a, dir, len, normal});
+            };
+
+            // Bucket the edges into the cells they touch.
+            void buildIndex() {
+                uint32_t numItems = edges.size();
+
+                cellStart.assign(cols*rows + 1, 0);
+
+                // count, then prefix sum, then fill
+                for (uint32_t i = 0; i < numItems; ++i) {
+                    ZMath::Vec2D min = itemMin(i), max = itemMax(i);
+                    for (int y = cellY(min.y); y <= cellY(max.y); ++y) {
+                        for (int x = cellX(min.x); x <= cellX(max.x); ++x) { cellStart[y*cols + x + 1]++; }
+                    }
+                }
+
+                for (int i = 0; i < cols*rows; ++i) { cellStart[i + 1] += cellStart[i]; }
+
+                cellItems.resize(cellStart[cols*rows]);
+                std::vector<uint32_t> fill(cellStart.begin(), cellStart.end() - 1);
+
+                for (uint32_t i = 0; i < numItems; ++i) {
+                    ZMath::Vec2D min = itemMin(i), max = itemMax(i);
+                    for (int y = cellY(min.y); y <= cellY(max.y); ++y) {
+                        for (int x = cellX(min.x); x <= cellX(max.x); ++x) { cellItems[fill[y*cols + x]++] = i; }
+                    }
+                }
+            };
+
+        public:
+            Boundary() = default;
+
+            /**
+             * @brief Build the outline of the solid tiles of a grid. Anything outside the grid counts as solid.
+             *
+             * @param width Number of columns.
+             * @param height Number of rows.
+             * @param tile Size of a tile.
+             * @param origin Position of the top left corner of the grid.
+             * @param solid solid(row, col) tells if a tile is a wall.
+             * @param tilesPerCell Width of the index's cells in tiles.
+             */
+            template <typename Solid>
+            void build(uint32_t width, uint32_t height, float tile, ZMath::Vec2D const &origin, Solid const &solid, uint32_t tilesPerCell = 4) {
+                clear();
+
+                auto at = [&](int row, int col) { return row < 0 || col < 0 || row >= (int) height || col >= (int) width || solid(row, col); };
+
+                // horizontal edges, on the line above each row, merged along the line
+                for (int y = 0; y <= (int) height; ++y) {
+                    for (int side = 0; side < 2; ++side) {
+                        // side 0: top faces (open above, wall below), side 1: bottom faces (wall above, open below)
+                        int wallRow = side ? y - 1 : y, openRow = side ? y : y - 1;
+                        ZMath::Vec2D normal(0.0f, side ? 1.0f : -1.0f);
+
+                        for (int x = 0; x < (int) width;) {
+                            if (!at(wallRow, x) || at(openRow, x)) { ++x; continue; }
+
+                            int start = x;
+                            while (x < (int) width && at(wallRow, x) && !at(openRow, x)) { ++x; }
+                            addEdge(origin + ZMath::Vec2D(start*tile, y*tile), ZMath::Vec2D(1.0f, 0.0f), (x - start)*tile, normal);
+                        }
+                    }
+                }
+
+                // vertical edges, on the line left of each column, merged along the line
+                for (int x = 0; x <= (int) width; ++x) {
+                    for (int side = 0; side < 2; ++side) {
+                        // side 0: left faces (open left, wall right), side 1: right faces (wall left, open right)
+                        int wallCol = side ? x - 1 : x, openCol = side ? x : x - 1;
+                        ZMath::Vec2D normal(side ? 1.0f : -1.0f, 0.0f);
+
+                        for (int y = 0; y < (int) height;) {
+                            if (!at(y, wallCol) || at(y, openCol)) { ++y; continue; }
+
+                            int start = y;
+                            while (y < (int) height && at(y, wallCol) && !at(y, openCol)) { ++y; }
+                            addEdge(origin + ZMath::Vec2D(x*tile, start*tile), ZMath::Vec2D(0.0f, 1.0f), (y - start)*tile, normal);
+                        }
+                    }
+                }
+
+                this->origin = origin;
+                cellSize = tilesPerCell*tile;
+                cols = (int) ((width + tilesPerCell - 1)/tilesPerCell) + 1;
+                rows = (int) ((height + tilesPerCell - 1)/tilesPerCell) + 1;
+                buildIndex();
+            };
+
+            // * Remove every edge.
+            void clear() {
+                edges.clear();
+                cellStart.clear();
+                cellItems.clear();
+                cols = rows = 0;
+            };
+
+            /**
+             * @brief Call fn(item) once for every edge in the cells a box touches.
+             *
+             * @param box Box to query.
+             * @param fn Called with the index of each edge, to pass to edge(). Safe to call from several threads at once.
+             */
+            template <typename Fn>
+            void query(AABB const &box, Fn const &fn) const {
+                if (!cols) { return; }
+
+                ZMath::Vec2D min = box.getMin(), max = box.getMax();
+                int x0 = cellX(min.x), x1 = cellX(max.x), y0 = cellY(min.y), y1 = cellY(max.y);
+
+                for (int y = y0; y <= y1; ++y) {
+                    for (int x = x0; x <= x1; ++x) {
+                        for (uint32_t i = cellStart[y*cols + x]; i < cellStart[y*cols + x + 1]; ++i) {
+                            uint32_t item = cellItems[i];
+
+                            // an edge spanning several cells is only reported from the first cell it shares with the query
+                            ZMath::Vec2D first = itemMin(item);
+                            if (ZMath::max(cellX(first.x), x0) != x || ZMath::max(cellY(first.y), y0) != y) { continue; }
+
+                            fn(item);
+                        }
+                    }
+                }
+            };
+
+            inline Edge const& edge(uint32_t item) const { return edges[item]; };
+
+            inline size_t numEdges() const { return edges.size(); };
+
+            // * Bytes of memory used.
+            inline size_t bytes() const {
+                return edges.capacity()*sizeof(Edge) + (cellStart.capacity() + cellItems.capacity())*sizeof(uint32_t);
+            };
+    };
+}
+
+#endif // !BOUNDARY_H
@@ -0,0 +1,73 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "physics.h"
+
+// * =====================================
+// * Sort and Sweep Broadphase
+// * =====================================
+
+// ? Finds the pairs of circles whose bounding boxes overlap. Circles are kept sorted by the left edge of their bounding
+// ?  box, then swept left to right: each circle is only compared with the ones that start before it ends.
+// ? The order is kept between calls and re-sorted with insertion sort. Bodies only move a little per step so the order is
+// ?  almost sorted, which insertion sort handles in close to linear time. The whole pass is O(n + pairs) rather than O(n^2).
+
+namespace Physics {
+    class SweepAndPrune {
+        private:
+            std::vector<uint32_t> order; // circle indices sorted by the left edge of their bounding box.
+
+        public:
+            SweepAndPrune() = default;
+
+            // * Reserve room for n circles so later calls with up to n circles do not allocate.
+            inline void reserve(size_t n) { order.reserve(n); };
+
+            /**
+             * @brief Call fn(i, j) for every pair of active circles whose bounding boxes overlap, with i != j.
+             *        The circles are indexed the same on every call. Changing their number resets the order.
+             *
+             * @param circles The circles.
+             * @param active Which circles take part. Null for all of them.
+             * @param n Number of circles.
+             * @param fn Called with the indices of each overlapping pair. It may move the circles.
+             */
+            template <typename Fn>
+            void findPairs(Circle const* circles, bool const* active, size_t n, Fn const &fn) {
+                if (order.size() != n) {
+                    order.resize(n);
+                    for (size_t i = 0; i < n; ++i) { order[i] = i; }
+                }
+
+                // insertion sort on the left edges, nearly linear as the order only changes a little between calls
+                for (size_t i = 1; i < n; ++i) {
+                    uint32_t id = order[i];
+                    float left = circles[id].c.x - circles[id].r;
+
+                    size_t j = i;
+                    for (; j > 0 && circles[order[j - 1]].c.x - circles[order[j - 1]].r > left; --j) { order[j] = order[j - 1]; }
+                    order[j] = id;
+                }
+
+                for (size_t i = 0; i < n; ++i) {
+                    uint32_t a = order[i];
+                    if (active && !active[a]) { continue; }
+
+                    float right = circles[a].c.x + circles[a].r;
+
+                    for (size_t j = i + 1; j < n; ++j) {
+                        uint32_t b = order[j];
+                        if (circles[b].c.x - circles[b].r > right) { break; }
+                        if (active && !active[b]) { continue; }
+
+                        if (ZMath::abs(circles[a].c.y - circles[b].c.y) <= circles[a].r + circles[b].r) { fn(a, b); }
+                    }
+                }
+            };
+    };
+}
+
+#endif // !BROADPHASE_H
@@ -0,0 +1,112 @@
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+// * =====================================
+// * Runtime CPU Feature Dispatch
+// * =====================================
+
+// ? One binary runs on machines with different SIMD support. Batched kernels are written once as plain loops and
+// ?  compiled for each level below with the target attribute, letting the compiler vectorize every copy for its
+// ?  instruction set. The best level the CPU supports is picked once at startup.
+// ? Fused multiply-adds are never generated (AVX-512 implies FMA, so contraction is turned off for it), so every level
+// ?  performs the same float operations and returns bit-identical results.
+// ?  `make bench` checks each supported level against the scalar reference.
+// ? On compilers or architectures without the target attribute only the scalar level exists.
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define ZMATH_DISPATCH
+    #define ZMATH_INLINE __attribute__((always_inline)) inline
+
+    // The scalar reference is not vectorized so it can be used to verify the other levels.
+    #define ZMATH_TARGET_SCALAR __attribute__((optimize("no-tree-vectorize")))
+    #define ZMATH_TARGET_SSE41 __attribute__((target("sse4.1")))
+    #define ZMATH_TARGET_AVX2 __attribute__((target("avx2")))
+    #define ZMATH_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx512vl,avx512dq,prefer-vector-width=512"), optimize("fp-contract=off")))
+#else
+    #define ZMATH_INLINE inline
+    #define ZMATH_TARGET_SCALAR
+    #define ZMATH_TARGET_SSE41
+    #define ZMATH_TARGET_AVX2
+    #define ZMATH_TARGET_AVX512
+#endif
+
+namespace Dispatch {
+    // * SIMD levels in increasing order of preference.
+    enum Level {
+        SCALAR,
+        SSE41,
+        AVX2,
+        AVX512,
+        NUM_LEVELS
+    };
+
+    inline const char* name(Level level) {
+        static const char* names[NUM_LEVELS] = {"scalar", "SSE4.1", "AVX2", "AVX-512"};
+        return names[level];
+    };
+
+    // * Can this CPU run a level.
+    inline bool supported(Level level) {
+        #ifdef ZMATH_DISPATCH
+            switch (level) {
+                case SCALAR: return 1;
+                case SSE41: return __builtin_cpu_supports("sse4.1");
+                case AVX2: return __builtin_cpu_supports("avx2");
+                case AVX512: return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+                                    __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("avx512dq");
+                default: return 0;
+            }
+        #else
+            return level == SCALAR;
+        #endif
+    };
+
+    // * Best level supported by this CPU.
+    inline Level detect() {
+        for (int l = NUM_LEVELS - 1; l > SCALAR; --l) {
+            if (supported((Level) l)) { return (Level) l; }
+        }
+
+        return SCALAR;
+    };
+
+    namespace Detail {
+        inline Level& current() {
+            static Level level = detect();
+            return level;
+        };
+    }
+
+    // * Level used by every dispatched kernel.
+    inline Level active() { return Detail::current(); };
+
+    /**
+     * @brief Use a specific level for every dispatched kernel, e.g. to verify it or compare levels in benchmarks.
+     *        Levels this CPU does not support are lowered to the best one it does.
+     *
+     * @param level The level to use.
+     * @return The level that will actually be used.
+     */
+    inline Level force(Level level) {
+        while (level > SCALAR && !supported(level)) { level = (Level) (level - 1); }
+        Detail::current() = level;
+        return level;
+    };
+}
+
+// * Define NAMEScalar, NAMESSE41, NAMEAVX2, and NAMEAVX512, each compiling LOOP for its level.
+// * TEMPLATE is the template header of the kernel, or empty. PARAMS and ARGS are parenthesized lists.
+// * LOOP should be ZMATH_INLINE so it is compiled into each variant with that variant's target.
+#define ZMATH_MULTIVERSION(TEMPLATE, RET, NAME, PARAMS, ARGS, LOOP) \
+    TEMPLATE inline ZMATH_TARGET_SCALAR RET NAME##Scalar PARAMS { return LOOP ARGS; } \
+    TEMPLATE inline ZMATH_TARGET_SSE41 RET NAME##SSE41 PARAMS { return LOOP ARGS; } \
+    TEMPLATE inline ZMATH_TARGET_AVX2 RET NAME##AVX2 PARAMS { return LOOP ARGS; } \
+    TEMPLATE inline ZMATH_TARGET_AVX512 RET NAME##AVX512 PARAMS { return LOOP ARGS; }
+
+// * Call the variant of a ZMATH_MULTIVERSION kernel for the active level.
+#define ZMATH_DISPATCH_CALL(NAME, ...) \
+    (Dispatch::active() == Dispatch::AVX512 ? NAME##AVX512(__VA_ARGS__) : \
+     Dispatch::active() == Dispatch::AVX2 ? NAME##AVX2(__VA_ARGS__) : \
+     Dispatch::active() == Dispatch::SSE41 ? NAME##SSE41(__VA_ARGS__) : NAME##Scalar(__VA_ARGS__))
+
+#endif // !DISPATCH_H
@@ -0,0 +1,370 @@
+#ifndef DISTFIELD_H
+#define DISTFIELD_H
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include "analyzer.h"
+#include "jobs.h"
+
+// * =====================================
+// * Stroke-to-Hole Distance Field
+// * =====================================
+
+// ? For every tile the ball can rest on, the fewest strokes needed to sink the ball and a shot that achieves it.
+// ? A fixed fan of shots (a grid of aim and strength bins plus a few putts straight at the hole) is fired from the centre
+// ?  of each tile. Where each one ends gives a graph between tiles, and a breadth-first search backwards from the hole
+// ?  gives the stroke counts. The ball rests anywhere in a tile but is treated as if it were at the centre.
+// ? The graph is built by a background job, closest tiles to the hole first. After each chunk of tiles the search is
+// ?  rerun and the results are published, so lookups improve while the field is being built and are exact once ready().
+// ? Lookups are O(1) reads of atomics and never block or allocate, so the game can query the field every frame.
+// ? A finished field is saved next to the map and loaded instead of rebuilt as long as the map's checksum still matches.
+
+namespace DistField {
+    struct Options {
+        uint angles = 48; // aim directions fired from each tile.
+        uint powers = 12; // shot strengths fired from each tile.
+        float minPower = 24.0f; // weakest shot in pixels dragged.
+        float maxPower = 1200.0f; // strongest shot in pixels dragged.
+        float timeStep = 0.0167f; // same step as the game loop.
+        uint maxSteps = 3600; // a shot still moving after this many steps is stopped where it is.
+        uint chunk = 32; // tiles simulated between publishing results.
+    };
+
+    // Marks a tile the hole has not (yet) been reached from.
+    static const uint8_t UNREACHED = 0xff;
+
+    // Putt speeds at the hole. A ball is only caught below sqrt(20000) ~ 141.
+    static const float PUTT_SPEEDS[3] = {40.0f, 80.0f, 120.0f};
+    static const uint NUM_PUTTS = 3;
+
+    class Field {
+        private:
+            static constexpr uint32_t FILE_MAGIC = 0x46445354; // "TSDF"
+            static constexpr uint32_t FILE_VERSION = 1;
+
+            TrickShot::Stage const* stage = nullptr;
+            TrickShot::Ball ball; // copy of the stage's ball taken in start(), as the game moves the stage's own while this builds.
+            Options opt;
+            uint width = 0, height = 0;
+            uint32_t startTile = 0;
+            uint32_t holeTile = 0;
+
+            std::unique_ptr<std::atomic<uint8_t>[]> strokes; // fewest strokes per tile, row major.
+            std::unique_ptr<std::atomic<uint32_t>[]> hints; // index of the shot that achieves them.
+
+            std::atomic<uint> built{0}; // tiles simulated so far.
+            uint numPlayable = 0;
+            std::atomic<bool> finished{0};
+            std::atomic<bool> stopping{0};
+            Jobs::Handle job; // background build.
+            std::string path;
+
+            inline uint shotsPerTile() const { return opt.angles*opt.powers + NUM_PUTTS; };
+
+            inline ZMath::Vec2D tileCentre(uint32_t tile) const {
+                return stage->getOffset() + ZMath::Vec2D((tile % width)*16 + 8.0f, (tile / width)*16 + 8.0f);
+            };
+
+            // Fire every shot from one tile and record where each one ends (Analyzer::SUNK if it went in).
+            void simulateTile(uint32_t tile, ZMath::Vec2D const &hole, uint32_t* outcomes) const {
+                ZMath::Vec2D start = tileCentre(tile);
+
+                for (uint s = 0; s < shotsPerTile(); ++s) {
+                    TrickShot::Ball shot = ball;
+                    shot.hitbox.c = start;
+                    shot.prevPos = start;
+                    shot.vel = shotVector(s, start, hole);
+                    shot.canHit = 1;
+
+                    TrickShot::StepResult res = stage->simulate(shot, opt.timeStep, opt.maxSteps);
+                    outcomes[s] = res == TrickShot::SUNK ? Analyzer::SUNK : Analyzer::landingTile(*stage, shot.hitbox.c, tile);
+                }
+            };
+
+            // Breadth-first search backwards from the hole over the simulated part of the graph, then publish.
+            void solve(std::vector<uint32_t> const &outcomes, std::vector<uint32_t> const &done, std::vector<uint32_t> const &slot) {
+                uint n = width*height, shots = shotsPerTile();
+                std::vector<uint8_t> dist(n, UNREACHED);
+                std::vector<uint32_t> best(n, 0), queue;
+
+                // reverse edges: for each tile, the (tile, shot) pairs landing on it
+                std::vector<uint32_t> start(n + 1, 0), from;
+
+                for (uint32_t t : done) {
+                    uint32_t const* out = &outcomes[slot[t]*shots];
+
+                    for (uint s = 0; s < shots; ++s) {
+                        if (out[s] == Analyzer::SUNK) {
+                            if (dist[t] == UNREACHED) { dist[t] = 1; best[t] = s; queue.push_back(t); }
+
+                        } else if (out[s] != t) {
+                            start[out[s] + 1]++;
+                        }
+                    }
+                }
+
+                for (uint i = 0; i < n; ++i) { start[i + 1] += start[i]; }
+                from.resize(start[n]);
+
+                std::vector<uint32_t> fill(start.begin(), start.end() - 1);
+                for (uint32_t t : done) {
+                    uint32_t const* out = &outcomes[slot[t]*shots];
+
+                    for (uint s = 0; s < shots; ++s) {
+                        if (out[s] != Analyzer::SUNK && out[s] != t) { from[fill[out[s]]++] = t*shots + s; }
+                    }
+                }
+
+                for (size_t head = 0; head < queue.size(); ++head) {
+                    uint32_t t = queue[head];
+                    if (dist[t] + 1 >= UNREACHED) { continue; }
+
+                    for (uint32_t e = start[t]; e < start[t + 1]; ++e) {
+                        uint32_t prev = from[e] / shots;
+
+                        if (dist[prev] == UNREACHED) {
+                            dist[prev] = dist[t] + 1;
+                            best[prev] = from[e] % shots;
+                            queue.push_back(prev);
+                        }
+                    }
+                }
+
+                // only publish improvements so a lookup never gets worse while the field is being built
+                for (uint i = 0; i < n; ++i) {
+                    if (dist[i] < strokes[i].load(std::memory_order_relaxed)) {
+                        hints[i].store(best[i], std::memory_order_relaxed);
+                        strokes[i].store(dist[i], std::memory_order_release);
+                    }
+                }
+            };
+
+            void build() {
+                TRACE_SCOPE("DistField::build", "analysis");
+
+                std::vector<uint32_t> order;
+                for (uint32_t t = 0; t < width*height; ++t) {
+                    if (Analyzer::isPlayable(stage->tileAt(t / width, t % width))) { order.push_back(t); }
+                }
+
+                // closest tiles to the hole first, as every path ends through them
+                ZMath::Vec2D hole = tileCentre(holeTile);
+                std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+                    return tileCentre(a).distSq(hole) < tileCentre(b).distSq(hole);
+                });
+
+                uint shots = shotsPerTile();
+                std::vector<uint32_t> outcomes(order.size()*shots), slot(width*height, 0), done;
+                done.reserve(order.size());
+
+                for (size_t i = 0; i < order.size() && !stopping; ++i) {
+                    slot[order[i]] = i;
+                    simulateTile(order[i], hole, &outcomes[i*shots]);
+                    done.push_back(order[i]);
+                    built++;
+
+                    if (done.size() % opt.chunk == 0 || done.size() == order.size()) { solve(outcomes, done, slot); }
+                }
+
+                if (stopping) { return; }
+
+                finished = 1;
+                if (!path.empty() && !save(path.c_str())) { fprintf(stderr, "Could not write '%s'.\n", path.c_str()); }
+            };
+
+        public:
+            Field() {};
+
+            Field(Field const &) = delete;
+            Field& operator = (Field const &) = delete;
+
+            ~Field() { stop(); };
+
+            /**
+             * @brief Load the field from a file, or start building it as a background job if that fails.
+             *        Calling start on a field that is already started does nothing.
+             *
+             * @param stage Stage to build the field for. It must stay loaded and unchanged until stop() or destruction. Only
+             *              its balls may change meanwhile, as the build never reads them after this call.
+             * @param path File to load the field from and save it to once built. Empty to neither load nor save.
+             * @param options Shot fan and simulation settings. A saved field only loads with the same settings.
+             */
+            void start(TrickShot::Stage const &stage, std::string const &path, Options const &options = Options()) {
+                if (this->stage) { return; }
+
+                this->stage = &stage;
+                ball = stage.getBall();
+                this->path = path;
+                opt = options;
+                width = stage.width;
+                height = stage.height;
+                startTile = Analyzer::landingTile(stage, stage.getStartingPos(), 0);
+
+                strokes.reset(new std::atomic<uint8_t>[width*height]);
+                hints.reset(new std::atomic<uint32_t>[width*height]);
+                numPlayable = 0;
+
+                for (uint i = 0; i < width*height; ++i) {
+                    char tile = stage.tileAt(i / width, i % width);
+                    if (tile == 'h') { holeTile = i; }
+
+                    strokes[i] = UNREACHED;
+                    hints[i] = 0;
+                    numPlayable += Analyzer::isPlayable(tile);
+                }
+
+                if (!path.empty() && load(path.c_str())) {
+                    built = numPlayable;
+                    finished = 1;
+                    return;
+                }
+
+                job = Jobs::get().submit([this] { build(); }, {}, Jobs::BACKGROUND);
+            };
+
+            // * Stop building (if still running) and wait for the background job.
+            void stop() {
+                stopping = 1;
+                Jobs::get().wait(job);
+                job.reset();
+            };
+
+            // * Has the whole field been built or loaded.
+            inline bool ready() const { return finished; };
+
+            // * Fraction of the tiles simulated so far.
+            inline float progress() const { return numPlayable ? (float) built / numPlayable : 0.0f; };
+
+            /**
+             * @brief Fewest strokes to sink the ball from a tile.
+             *
+             * @return UNREACHED if the hole cannot be reached from the tile, or has not been found to be yet.
+             */
+            inline uint8_t strokesAt(uint row, uint col) const {
+                if (!strokes || row >= height || col >= width) { return UNREACHED; }
+                return strokes[row*width + col].load(std::memory_order_acquire);
+            };
+
+            // * Fewest strokes from the start of the stage, or UNREACHED.
+            inline uint8_t par() const { return strokes ? strokes[startTile].load(std::memory_order_acquire) : UNREACHED; };
+
+            /**
+             * @brief The shot vector (as passed to Stage::shoot) of the best first shot from a ball position.
+             *
+             * @param pos Position of the ball.
+             * @param shot Filled with the shot.
+             * @return The strokes left after taking the shot's tile into account, or UNREACHED (and shot untouched).
+             */
+            uint8_t hint(ZMath::Vec2D const &pos, ZMath::Vec2D &shot) const {
+                if (!strokes) { return UNREACHED; }
+
+                uint32_t tile = Analyzer::landingTile(*stage, pos, Analyzer::SUNK);
+                if (tile == Analyzer::SUNK) { return UNREACHED; }
+
+                uint8_t n = strokes[tile].load(std::memory_order_acquire);
+                if (n == UNREACHED) { return n; }
+
+                shot = shotVector(hints[tile].load(std::memory_order_relaxed), pos, tileCentre(holeTile));
+                return n;
+            };
+
+            /**
+             * @brief The shot vector for a shot index: angle-major over the aim and strength grid, then the putts.
+             *
+             * @param s Shot index.
+             * @param from Position the shot is fired from.
+             * @param hole Centre of the hole, for the putts.
+             */
+            ZMath::Vec2D shotVector(uint s, ZMath::Vec2D const &from, ZMath::Vec2D const &hole) const {
+                if (s >= opt.angles*opt.powers) {
+                    // a ball shot at v0 travels about v0 * dt / (1 - damping), so reaching the hole at speed v takes
+                    // v0 = d * (1 - damping) / dt + v.
+                    ZMath::Vec2D toHole = hole - from;
+                    float d = toHole.mag();
+                    if (d < 1.0f) { return ZMath::Vec2D(opt.minPower, 0.0f); }
+
+                    float travel = opt.timeStep / (1.0f - ball.linearDamping);
+                    return toHole * ((d/travel + PUTT_SPEEDS[s - opt.angles*opt.powers])/d);
+                }
+
+                float angle = (s / opt.powers) * 2.0f*PI/opt.angles;
+                float power = opt.minPower + (s % opt.powers) * (opt.maxPower - opt.minPower)/(opt.powers - 1);
+                return ZMath::Vec2D(cosf(angle), sinf(angle)) * power;
+            };
+
+            /**
+             * @brief Write the field to a file. Only call once ready().
+             *
+             * @return Was the file written.
+             */
+            bool save(const char* path) const {
+                FILE* f = fopen(path, "wb");
+                if (!f) { return 0; }
+
+                uint64_t checksum = stage->getChecksum();
+                uint32_t size[2] = {width, height};
+                bool ok = fwrite(&FILE_MAGIC, sizeof(FILE_MAGIC), 1, f) && fwrite(&FILE_VERSION, sizeof(FILE_VERSION), 1, f) &&
+                          fwrite(&checksum, sizeof(checksum), 1, f) && fwrite(size, sizeof(size), 1, f) && fwrite(&opt, sizeof(opt), 1, f);
+
+                for (uint i = 0; ok && i < width*height; ++i) {
+                    uint8_t n = strokes[i];
+                    uint32_t h = hints[i];
+                    ok = fwrite(&n, sizeof(n), 1, f) && fwrite(&h, sizeof(h), 1, f);
+                }
+
+                return !fclose(f) && ok;
+            };
+
+            /**
+             * @brief Read a field written by save().
+             *
+             * @return 0 if the file is missing, unreadable, or was written for a different map or with different settings.
+             */
+            bool load(const char* path) {
+                FILE* f = fopen(path, "rb");
+                if (!f) { return 0; }
+
+                uint32_t magic = 0, version = 0, size[2] = {0, 0};
+                uint64_t checksum = 0;
+                Options fileOpt;
+
+                bool ok = fread(&magic, sizeof(magic), 1, f) && fread(&version, sizeof(version), 1, f) &&
+                          fread(&checksum, sizeof(checksum), 1, f) && fread(size, sizeof(size), 1, f) &&
+                          fread(&fileOpt, sizeof(fileOpt), 1, f) && magic == FILE_MAGIC && version == FILE_VERSION &&
+                          checksum == stage->getChecksum() && size[0] == width && size[1] == height &&
+                          !memcmp(&fileOpt, &opt, sizeof(opt));
+
+                std::vector<uint8_t> n(width*height);
+                std::vector<uint32_t> h(width*height);
+
+                for (uint i = 0; ok && i < width*height; ++i) { ok = fread(&n[i], sizeof(n[i]), 1, f) && fread(&h[i], sizeof(h[i]), 1, f); }
+                fclose(f);
+
+                if (!ok) { return 0; }
+
+                for (uint i = 0; i < width*height; ++i) {
+                    strokes[i] = n[i];
+                    hints[i] = h[i];
+                }
+
+                return 1;
+            };
+    };
+
+    // * Path a map's field is saved to: the map path with its extension replaced by .dist.
+    inline std::string fieldPath(std::string const &mappath) {
+        size_t dot = mappath.rfind('.');
+        size_t slash = mappath.find_last_of("/\\");
+
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) { return mappath + ".dist"; }
+        return mappath.substr(0, dot) + ".dist";
+    };
+}
+
+#endif // !DISTFIELD_H
@@ -0,0 +1,441 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "parallel.h"
+#include "rng.h"
+#include "trickshot.h"
+
+// * =====================================
+// * Procedural Level Generator
+// * =====================================
+
+// ? Candidates are built on a grid: border walls, straight interior wall segments, 2x2 boost panels, and sand and
+// ?  water grown as blobs. The ball and hole go on open tiles far apart by walking distance.
+// ? Colliders are made by greedily merging tiles of the same type into rectangles, and the result is written in the
+// ?  .map format and loaded back through Stage::loadMap, so a candidate is validated exactly as the game will load it.
+// ? Validation searches for a way to sink the ball one stroke at a time. Each stroke fires putts straight at the hole
+// ?  and a ring of exploration shots from every position in the frontier, then keeps the new resting positions closest
+// ?  to the hole by walking distance. The par is the number of strokes this search needed, so it is an upper bound on
+// ?  the true minimum. Candidates that are not solved within the maximum par, or are solved too quickly, are rejected.
+// ? Each candidate gets its own generator split from the seed, so a pack only depends on the seed and parameters.
+
+namespace Generator {
+    struct Params {
+        uint width = 60; // grid size including the border walls. At most 112 x 56 to fit the screen.
+        uint height = 20;
+
+        // Interior tile counts. -1 picks a count from the grid size (and hazard density for sand and water).
+        int walls = -1;
+        int panels = -1;
+        int sand = -1;
+        int water = -1;
+
+        float hazardDensity = 0.12f; // fraction of the interior covered by sand and water when their counts are -1.
+
+        uint minPar = 2; // accepted par range. 1 <= minPar <= maxPar.
+        uint maxPar = 4;
+        uint triesPerLevel = 1000; // give up after this many candidates per level asked for.
+
+        // validation search
+        uint angles = 24; // exploration shots per position.
+        uint frontier = 8; // positions kept per stroke.
+        float timeStep = 0.0167f; // same step as the game loop.
+        uint maxSteps = 1200; // a shot still moving after this many steps is stopped where it is.
+    };
+
+    struct Level {
+        std::string map; // contents of the .map file.
+        uint par = 0; // 0 if the candidate was rejected.
+    };
+
+    struct Stats {
+        uint64_t candidates = 0; // candidates generated.
+        double seconds = 0.0;
+    };
+
+    typedef std::vector<std::string> Grid;
+
+    // Can the ball travel over a tile.
+    inline bool passable(char tile) { return tile != 'w' && tile != 'W'; };
+
+    // Walking distance (4-connected, over passable tiles) from a tile to every other. Unreachable tiles are -1.
+    inline std::vector<int> distances(Grid const &grid, uint row, uint col) {
+        uint width = grid[0].size(), height = grid.size();
+        std::vector<int> dist(width*height, -1);
+        std::vector<uint> queue;
+        queue.reserve(width*height);
+
+        dist[row*width + col] = 0;
+        queue.push_back(row*width + col);
+
+        for (size_t head = 0; head < queue.size(); ++head) {
+            uint t = queue[head], r = t / width, c = t % width;
+            uint next[4] = {t - width, t + width, t - 1, t + 1};
+            bool valid[4] = {r > 0, r + 1 < height, c > 0, c + 1 < width};
+
+            for (int i = 0; i < 4; ++i) {
+                if (valid[i] && dist[next[i]] < 0 && passable(grid[next[i] / width][next[i] % width])) {
+                    dist[next[i]] = dist[t] + 1;
+                    queue.push_back(next[i]);
+                }
+            }
+        }
+
+        return dist;
+    };
+
+    // Is every tile in the 3x3 block around a tile empty.
+    inline bool openArea(Grid const &grid, uint row, uint col) {
+        for (uint r = row - 1; r <= row + 1; ++r) {
+            for (uint c = col - 1; c <= col + 1; ++c) {
+                if (grid[r][c] != ' ') { return 0; }
+            }
+        }
+
+        return 1;
+    };
+
+    // * A rectangle of tiles, in tiles.
+    struct Rect {
+        uint x, y, w, h;
+    };
+
+    // * Greedily merge the tiles of one type into as few rectangles as the scan finds: grow right, then down.
+    inline std::vector<Rect> mesh(Grid const &grid, char type) {
+        uint width = grid[0].size(), height = grid.size();
+        std::vector<uint8_t> used(width*height, 0);
+        std::vector<Rect> rects;
+
+        for (uint y = 0; y < height; ++y) {
+            for (uint x = 0; x < width; ++x) {
+                if (grid[y][x] != type || used[y*width + x]) { continue; }
+
+                uint w = 1;
+                while (x + w < width && grid[y][x + w] == type && !used[y*width + x + w]) { ++w; }
+
+                uint h = 1;
+                for (bool grow = 1; grow && y + h < height; h += grow) {
+                    for (uint i = x; i < x + w; ++i) {
+                        if (grid[y + h][i] != type || used[(y + h)*width + i]) { grow = 0; break; }
+                    }
+                }
+
+                for (uint j = y; j < y + h; ++j) {
+                    for (uint i = x; i < x + w; ++i) { used[j*width + i] = 1; }
+                }
+
+                rects.push_back({x, y, w, h});
+            }
+        }
+
+        return rects;
+    };
+
+    // * Write a grid and its colliders in the .map format (see assets/maps/map.info).
+    inline std::string toMap(Grid const &grid) {
+        std::vector<Rect> colliders[4] = {mesh(grid, 'w'), mesh(grid, 'B'), mesh(grid, 's'), mesh(grid, 'W')};
+        std::ostringstream out;
+
+        out << grid[0].size() << '\n' << grid.size() << '\n';
+        for (int i = 0; i < 4; ++i) { out << colliders[i].size() << '\n'; }
+        for (std::string const &row : grid) { out << row << '\n'; }
+
+        for (int i = 0; i < 4; ++i) {
+            for (Rect const &r : colliders[i]) {
+                out << r.x*16 << ',' << r.y*16 << '|' << (r.x + r.w)*16 << ',' << (r.y + r.h)*16 << '\n';
+            }
+        }
+
+        return out.str();
+    };
+
+    // Random interior tile.
+    inline void randomTile(Grid const &grid, Random::Rng &rng, uint &row, uint &col) {
+        row = 1 + rng.next() % (grid.size() - 2);
+        col = 1 + rng.next() % (grid[0].size() - 2);
+    };
+
+    // Grow a blob of a tile type from a random empty tile until it has size tiles or cannot grow. Returns the tiles placed.
+    inline uint growBlob(Grid &grid, Random::Rng &rng, char type, uint size) {
+        uint row, col;
+        randomTile(grid, rng, row, col);
+        if (grid[row][col] != ' ') { return 0; }
+
+        std::vector<std::pair<uint, uint>> blob = {{row, col}};
+        grid[row][col] = type;
+
+        for (uint tries = 0; blob.size() < size && tries < 8*size; ++tries) {
+            auto [r, c] = blob[rng.next() % blob.size()];
+            uint dir = rng.next() % 4;
+
+            r += dir == 0 ? 1 : (dir == 1 ? -1 : 0);
+            c += dir == 2 ? 1 : (dir == 3 ? -1 : 0);
+
+            if (grid[r][c] == ' ') {
+                grid[r][c] = type;
+                blob.push_back({r, c});
+            }
+        }
+
+        return blob.size();
+    };
+
+    /**
+     * @brief Build a candidate grid. Returns an empty grid if the ball and hole could not be placed.
+     */
+    inline Grid buildGrid(Params const &p, Random::Rng &rng) {
+        uint interior = (p.width - 2)*(p.height - 2);
+        uint walls = p.walls >= 0 ? p.walls : interior/16;
+        uint panels = p.panels >= 0 ? p.panels : (interior/150)*4;
+        uint hazards = (uint) (p.hazardDensity * interior);
+        uint sand = p.sand >= 0 ? p.sand : hazards - hazards*2/5;
+        uint water = p.water >= 0 ? p.water : hazards*2/5;
+
+        Grid grid(p.height, std::string(p.width, ' '));
+        for (uint c = 0; c < p.width; ++c) { grid[0][c] = grid[p.height - 1][c] = 'w'; }
+        for (uint r = 0; r < p.height; ++r) { grid[r][0] = grid[r][p.width - 1] = 'w'; }
+
+        uint maxTries = 64*interior;
+        uint placed = 0;
+
+        // straight wall segments two tiles thick
+        for (uint tries = 0; placed < walls && tries < maxTries; ++tries) {
+            uint row, col;
+            randomTile(grid, rng, row, col);
+
+            bool vertical = rng.next() & 1;
+            uint length = 3 + rng.next() % 6;
+
+            for (uint i = 0; i < length && placed < walls; ++i) {
+                for (uint j = 0; j < 2 && placed < walls; ++j) {
+                    uint r = row + (vertical ? i : j), c = col + (vertical ? j : i);
+                    if (r + 1 >= p.height || c + 1 >= p.width) { continue; }
+                    if (grid[r][c] == ' ') { grid[r][c] = 'w'; ++placed; }
+                }
+            }
+        }
+
+        // 2x2 boost panels
+        placed = 0;
+        for (uint tries = 0; placed < panels && tries < maxTries; ++tries) {
+            uint row, col;
+            randomTile(grid, rng, row, col);
+            if (row + 2 >= p.height || col + 2 >= p.width) { continue; }
+
+            if (grid[row][col] == ' ' && grid[row][col + 1] == ' ' && grid[row + 1][col] == ' ' && grid[row + 1][col + 1] == ' ') {
+                grid[row][col] = grid[row][col + 1] = grid[row + 1][col] = grid[row + 1][col + 1] = 'B';
+                placed += 4;
+            }
+        }
+
+        placed = 0;
+        for (uint tries = 0; placed < sand && tries < maxTries; ++tries) { placed += growBlob(grid, rng, 's', std::min((uint) (4 + rng.next() % 16), sand - placed)); }
+
+        placed = 0;
+        for (uint tries = 0; placed < water && tries < maxTries; ++tries) { placed += growBlob(grid, rng, 'W', std::min((uint) (4 + rng.next() % 12), water - placed)); }
+
+        // ball on an open tile
+        uint ballRow = 0, ballCol = 0;
+        for (uint tries = 0; tries < maxTries && !ballRow; ++tries) {
+            uint row, col;
+            randomTile(grid, rng, row, col);
+            if (openArea(grid, row, col)) { ballRow = row; ballCol = col; }
+        }
+
+        if (!ballRow) { return Grid(); }
+
+        // hole on an open tile at least 60% of the farthest reachable walking distance away
+        std::vector<int> dist = distances(grid, ballRow, ballCol);
+        int farthest = *std::max_element(dist.begin(), dist.end());
+        std::vector<uint> holes;
+
+        for (uint row = 1; row + 1 < p.height; ++row) {
+            for (uint col = 1; col + 1 < p.width; ++col) {
+                if (dist[row*p.width + col] * 5 >= farthest * 3 && openArea(grid, row, col)) { holes.push_back(row*p.width + col); }
+            }
+        }
+
+        if (holes.empty() || farthest < 4) { return Grid(); }
+
+        uint hole = holes[rng.next() % holes.size()];
+        grid[ballRow][ballCol] = 'b';
+        grid[hole / p.width][hole % p.width] = 'h';
+
+        return grid;
+    };
+
+    /**
+     * @brief Find how many strokes the validation search needs to sink the ball.
+     *
+     * @param stage The loaded candidate.
+     * @param grid The candidate's grid, used for walking distances to the hole.
+     * @param p Search parameters.
+     * @param rng Generator for the exploration shot offsets.
+     * @return The strokes needed, or 0 if the ball was not sunk within p.maxPar strokes.
+     */
+    inline uint findPar(TrickShot::Stage const &stage, Grid const &grid, Params const &p, Random::Rng &rng) {
+        uint width = grid[0].size(), height = grid.size();
+        uint holeTile = 0;
+
+        for (uint t = 0; t < width*height; ++t) { if (grid[t / width][t % width] == 'h') { holeTile = t; } }
+
+        std::vector<int> dist = distances(grid, holeTile / width, holeTile % width);
+        std::vector<uint8_t> seen(width*height, 0);
+
+        ZMath::Vec2D offset = stage.getOffset();
+        ZMath::Vec2D hole = offset + ZMath::Vec2D((holeTile % width)*16 + 8.0f, (holeTile / width)*16 + 8.0f);
+
+        // a ball shot at v0 travels about v0 * dt / (1 - damping), so a putt that reaches the hole at speed v needs
+        // v0 = d * (1 - damping) / dt + v. The hole only catches balls slower than sqrt(20000) ~ 141.
+        float travel = p.timeStep / (1.0f - stage.getBall().linearDamping);
+        static const float puttSpeeds[3] = {40.0f, 80.0f, 120.0f};
+        static const float powers[3] = {200.0f, 450.0f, 800.0f};
+
+        std::vector<ZMath::Vec2D> frontier = {stage.getStartingPos()}, shots;
+        std::vector<std::pair<int, ZMath::Vec2D>> next;
+
+        for (uint stroke = 1; stroke <= p.maxPar; ++stroke) {
+            next.clear();
+
+            for (ZMath::Vec2D const &pos : frontier) {
+                shots.clear();
+
+                ZMath::Vec2D toHole = hole - pos;
+                float d = toHole.mag();
+                for (float v : puttSpeeds) { shots.push_back(toHole * ((d/travel + v)/d)); }
+
+                float spin = rng.nextFloat();
+                for (uint a = 0; a < p.angles; ++a) {
+                    float angle = (a + spin) * 2.0f*PI/p.angles;
+                    for (float power : powers) { shots.push_back(ZMath::Vec2D(cosf(angle), sinf(angle)) * power); }
+                }
+
+                for (ZMath::Vec2D const &shot : shots) {
+                    TrickShot::Ball ball = stage.getBall();
+                    ball.hitbox.c = pos;
+                    ball.prevPos = pos;
+                    ball.vel = shot;
+                    ball.canHit = 1;
+
+                    TrickShot::StepResult res = stage.simulate(ball, p.timeStep, p.maxSteps);
+                    if (res == TrickShot::SUNK) { return stroke; }
+                    if (res == TrickShot::WATER) { continue; }
+
+                    ZMath::Vec2D local = (ball.hitbox.c - offset) * (1.0f/16.0f);
+                    if (local.x < 0.0f || local.y < 0.0f || local.x >= width || local.y >= height) { continue; }
+
+                    uint t = (uint) local.y * width + (uint) local.x;
+                    if (seen[t] || dist[t] < 0) { continue; }
+
+                    seen[t] = 1;
+                    next.push_back({dist[t], ball.hitbox.c});
+                }
+            }
+
+            uint keep = (uint) std::min((size_t) p.frontier, next.size());
+            std::partial_sort(next.begin(), next.begin() + keep, next.end(),
+                              [](auto const &a, auto const &b) { return a.first < b.first; });
+
+            frontier.clear();
+            for (uint i = 0; i < keep; ++i) { frontier.push_back(next[i].second); }
+            if (frontier.empty()) { return 0; }
+        }
+
+        return 0;
+    };
+
+    // * Build and validate one candidate. The returned level has par 0 if it was rejected.
+    inline Level makeLevel(Params const &p, Random::Rng rng) {
+        Level level;
+
+        Grid grid = buildGrid(p, rng);
+        if (grid.empty()) { return level; }
+
+        std::string map = toMap(grid);
+        std::istringstream in(map);
+
+        TrickShot::Stage stage;
+        stage.loadMap(in);
+
+        uint par = findPar(stage, grid, p, rng);
+        if (par >= p.minPar) {
+            level.map = std::move(map);
+            level.par = par;
+        }
+
+        return level;
+    };
+
+    /**
+     * @brief Generate validated levels.
+     *
+     * @param p Generation and validation parameters.
+     * @param count Number of levels to produce.
+     * @param threads Threads to use. 0 uses every hardware thread.
+     * @param seed Seed for the whole pack.
+     * @param stats Filled with the number of candidates tried and the time taken.
+     * @return count levels, in the same order for a given seed and parameters whatever the thread count. Fewer if
+     *         count*p.triesPerLevel candidates were tried first, e.g. when no grid of this shape can be solved within the par range.
+     */
+    inline std::vector<Level> generate(Params const &p, uint count, unsigned int threads, uint64_t seed, Stats &stats) {
+        TRACE_SCOPE("Generator::generate", "generator");
+
+        auto start = std::chrono::steady_clock::now();
+        size_t batch = std::max<size_t>(64, 16*(threads ? threads : Parallel::hardwareThreads()));
+
+        Random::Rng root(seed);
+        std::vector<Level> levels, results(batch);
+        std::vector<Random::Rng> rngs(batch);
+
+        uint64_t maxCandidates = (uint64_t) count*p.triesPerLevel;
+
+        while (levels.size() < count && stats.candidates < maxCandidates) {
+            for (Random::Rng &rng : rngs) { rng = root.split(); }
+
+            Parallel::forEach(batch, threads, [&](size_t i) { results[i] = makeLevel(p, rngs[i]); });
+            stats.candidates += batch;
+
+            for (Level &level : results) {
+                if (level.par && levels.size() < count) { levels.push_back(std::move(level)); }
+            }
+        }
+
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return levels;
+    };
+
+    // * Write levels to dir as level001.map, level002.map, ... and a pack.txt listing each file and its par.
+    inline bool writePack(std::vector<Level> const &levels, std::string const &dir) {
+        std::error_code err;
+        std::filesystem::create_directories(dir, err);
+
+        std::string indexPath = dir + "/pack.txt";
+        FILE* index = fopen(indexPath.c_str(), "w");
+        if (!index) { return 0; }
+
+        bool ok = 1;
+        char name[32];
+
+        for (size_t i = 0; i < levels.size(); ++i) {
+            snprintf(name, sizeof(name), "level%03zu.map", i + 1);
+
+            FILE* f = fopen((dir + "/" + name).c_str(), "w");
+            if (!f) { ok = 0; continue; }
+
+            ok &= fwrite(levels[i].map.data(), 1, levels[i].map.size(), f) == levels[i].map.size();
+            ok &= !fclose(f);
+            fprintf(index, "%s par %u\n", name, levels[i].par);
+        }
+
+        return !fclose(index) && ok;
+    };
+}
+
+#endif // !GENERATOR_H
@@ -0,0 +1,386 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// * =====================================
+// * Work-Stealing Job System
+// * =====================================
+
+// ? A fixed pool of worker threads, each with its own deque of jobs. A worker pushes and pops jobs at the back of its own
+// ?  deque (newest first, which keeps caches warm) and, when that is empty, steals from the front of the others' deques
+// ?  (oldest first, which tends to take the largest pieces of work). Jobs submitted from outside the pool go to a shared queue.
+// ? A job can depend on other jobs and only becomes runnable once they have all finished.
+// ? Jobs with MAIN affinity only run on the main thread (the one that first called Jobs::get()), for raylib calls that
+// ?  touch the GL context. The main thread runs them from runMainThreadJobs(), endFrame(), or while waiting.
+// ? BACKGROUND jobs only run on workers, so long precomputation never lands on the main thread while it waits or helps.
+// ? Waiting never just blocks: the waiting thread runs other jobs until the one it waits on finishes, so jobs can
+// ?  submit and wait on jobs of their own without starving the pool.
+// ? Frame jobs are jobs the main loop waits on in endFrame(), so work split across the pool is done by the end of the frame.
+
+namespace Jobs {
+    enum Affinity {
+        ANY, // run on any worker or a waiting thread.
+        MAIN, // run only on the main thread.
+        BACKGROUND // run only on a worker, for long jobs a waiting thread (such as the main loop) must not pick up.
+    };
+
+    class System;
+
+    class Task {
+        private:
+            std::function<void()> fn;
+            Affinity affinity = ANY;
+            std::atomic<int> pending{1}; // unfinished dependencies, plus 1 until the task is submitted.
+            std::atomic<bool> done{0};
+            std::mutex mutex; // guards dependents and the switch to done.
+            std::vector<std::shared_ptr<Task>> dependents; // tasks to release when this one finishes.
+
+            friend class System;
+
+        public:
+            // * Has the job run.
+            inline bool finished() const { return done.load(std::memory_order_acquire); };
+    };
+
+    // * Shared handle to a submitted job. Holding it does not keep the system busy.
+    typedef std::shared_ptr<Task> Handle;
+
+    class System {
+        private:
+            struct Worker {
+                std::mutex mutex;
+                std::deque<Handle> jobs;
+            };
+
+            // Which worker of which system the current thread is (index -1 for threads outside the pool).
+            struct ThreadInfo {
+                System const* system = nullptr;
+                int index = -1;
+            };
+
+            static ThreadInfo& threadInfo() {
+                static thread_local ThreadInfo info;
+                return info;
+            };
+
+            std::vector<std::unique_ptr<Worker>> workers;
+            std::vector<std::thread> threads;
+
+            std::mutex injectMutex;
+            std::deque<Handle> injected; // jobs submitted from outside the pool.
+
+            std::mutex backgroundMutex;
+            std::deque<Handle> backgroundJobs; // jobs with BACKGROUND affinity that are ready to run.
+            std::atomic<size_t> backgroundQueued{0};
+
+            std::mutex mainMutex;
+            std::deque<Handle> mainJobs; // jobs with MAIN affinity that are ready to run.
+            std::atomic<size_t> mainQueued{0};
+
+            std::mutex frameMutex;
+            std::vector<Handle> frameJobs; // jobs endFrame() waits on.
+            std::vector<Handle> frameWaiting; // reused by endFrame() so it does not allocate.
+
+            // Sleeping workers and waiters wait on sleepCv. Anything that makes work available or finishes a job notifies it.
+            std::mutex sleepMutex;
+            std::condition_variable sleepCv;
+            std::atomic<size_t> queued{0}; // ready jobs with ANY affinity.
+            std::atomic<bool> stopping{0};
+
+            std::thread::id mainThread;
+
+            inline int currentWorker() const {
+                ThreadInfo const &info = threadInfo();
+                return info.system == this ? info.index : -1;
+            };
+
+            void wake() {
+                { std::lock_guard<std::mutex> lock(sleepMutex); }
+                sleepCv.notify_all();
+            };
+
+            // Queue a job whose dependencies have all finished.
+            void schedule(Handle const &task) {
+                if (task->affinity == MAIN) {
+                    std::lock_guard<std::mutex> lock(mainMutex);
+                    mainJobs.push_back(task);
+                    mainQueued++;
+
+                } else if (task->affinity == BACKGROUND) {
+                    std::lock_guard<std::mutex> lock(backgroundMutex);
+                    backgroundJobs.push_back(task);
+                    backgroundQueued++;
+
+                } else {
+                    int self = currentWorker();
+
+                    if (self >= 0) {
+                        std::lock_guard<std::mutex> lock(workers[self]->mutex);
+                        workers[self]->jobs.push_back(task);
+
+                    } else {
+                        std::lock_guard<std::mutex> lock(injectMutex);
+                        injected.push_back(task);
+                    }
+
+                    queued++;
+                }
+
+                wake();
+            };
+
+            // Drop one pending count, scheduling the task once nothing is left.
+            void release(Handle const &task) {
+                if (task->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) { schedule(task); }
+            };
+
+            void run(Handle const &task) {
+                task->fn();
+                task->fn = nullptr; // free the captures now rather than when the last handle goes.
+
+                std::vector<Handle> dependents;
+                {
+                    std::lock_guard<std::mutex> lock(task->mutex);
+                    task->done.store(1, std::memory_order_release);
+                    dependents.swap(task->dependents);
+                }
+
+                for (Handle const &d : dependents) { release(d); }
+                wake();
+            };
+
+            // Take a job with ANY affinity: our own newest, then a submitted one, then the oldest of another worker.
+            bool take(Handle &job) {
+                if (!queued.load(std::memory_order_acquire)) { return 0; }
+
+                int self = currentWorker();
+                size_t n = workers.size();
+
+                if (self >= 0) {
+                    std::lock_guard<std::mutex> lock(workers[self]->mutex);
+
+                    if (!workers[self]->jobs.empty()) {
+                        job = std::move(workers[self]->jobs.back());
+                        workers[self]->jobs.pop_back();
+                        queued--;
+                        return 1;
+                    }
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(injectMutex);
+
+                    if (!injected.empty()) {
+                        job = std::move(injected.front());
+                        injected.pop_front();
+                        queued--;
+                        return 1;
+                    }
+                }
+
+                for (size_t i = 1; i <= n; ++i) {
+                    size_t victim = (self + i) % n;
+                    if ((int) victim == self) { continue; }
+
+                    std::lock_guard<std::mutex> lock(workers[victim]->mutex);
+
+                    if (!workers[victim]->jobs.empty()) {
+                        job = std::move(workers[victim]->jobs.front());
+                        workers[victim]->jobs.pop_front();
+                        queued--;
+                        return 1;
+                    }
+                }
+
+                return 0;
+            };
+
+            bool takeBackground(Handle &job) {
+                if (!backgroundQueued.load(std::memory_order_acquire)) { return 0; }
+
+                std::lock_guard<std::mutex> lock(backgroundMutex);
+                if (backgroundJobs.empty()) { return 0; }
+
+                job = std::move(backgroundJobs.front());
+                backgroundJobs.pop_front();
+                backgroundQueued--;
+                return 1;
+            };
+
+            bool takeMain(Handle &job) {
+                if (!mainQueued.load(std::memory_order_acquire)) { return 0; }
+
+                std::lock_guard<std::mutex> lock(mainMutex);
+                if (mainJobs.empty()) { return 0; }
+
+                job = std::move(mainJobs.front());
+                mainJobs.pop_front();
+                mainQueued--;
+                return 1;
+            };
+
+            void workerLoop(int index) {
+                threadInfo() = {this, index};
+
+                while (1) {
+                    Handle job;
+                    if (take(job) || takeBackground(job)) { run(job); continue; }
+
+                    std::unique_lock<std::mutex> lock(sleepMutex);
+                    if (stopping) { return; }
+                    sleepCv.wait(lock, [this] { return stopping || queued.load() > 0 || backgroundQueued.load() > 0; });
+                }
+            };
+
+        public:
+            /**
+             * @brief Start the pool. The calling thread becomes the main thread.
+             *
+             * @param numWorkers Worker threads to start. At least one is always started so background jobs make progress.
+             */
+            System(unsigned int numWorkers) : mainThread(std::this_thread::get_id()) {
+                if (!numWorkers) { numWorkers = 1; }
+
+                for (unsigned int i = 0; i < numWorkers; ++i) { workers.push_back(std::make_unique<Worker>()); }
+                for (unsigned int i = 0; i < numWorkers; ++i) { threads.emplace_back(&System::workerLoop, this, (int) i); }
+            };
+
+            System(System const &) = delete;
+            System& operator = (System const &) = delete;
+
+            // Finish every queued job with ANY or BACKGROUND affinity, then stop the workers.
+            ~System() {
+                {
+                    std::lock_guard<std::mutex> lock(sleepMutex);
+                    stopping = 1;
+                }
+
+                sleepCv.notify_all();
+                for (std::thread &t : threads) { t.join(); }
+            };
+
+            inline size_t numWorkers() const { return workers.size(); };
+
+            inline bool isMainThread() const { return std::this_thread::get_id() == mainThread; };
+
+            /**
+             * @brief Submit a job.
+             *
+             * @param fn Function to run.
+             * @param deps Jobs that must finish first. Null handles are ignored.
+             * @param affinity MAIN to only run the job on the main thread, BACKGROUND to only run it on a worker.
+             * @return Handle to wait on or to make other jobs depend on.
+             */
+            Handle submit(std::function<void()> fn, std::initializer_list<Handle> deps = {}, Affinity affinity = ANY) {
+                Handle task = std::make_shared<Task>();
+                task->fn = std::move(fn);
+                task->affinity = affinity;
+
+                for (Handle const &d : deps) {
+                    if (!d) { continue; }
+
+                    std::lock_guard<std::mutex> lock(d->mutex);
+                    if (!d->done.load(std::memory_order_relaxed)) {
+                        task->pending++;
+                        d->dependents.push_back(task);
+                    }
+                }
+
+                release(task);
+                return task;
+            };
+
+            // * Submit a job that endFrame() waits on.
+            Handle submitFrame(std::function<void()> fn, std::initializer_list<Handle> deps = {}, Affinity affinity = ANY) {
+                Handle task = submit(std::move(fn), deps, affinity);
+
+                std::lock_guard<std::mutex> lock(frameMutex);
+                frameJobs.push_back(task);
+                return task;
+            };
+
+            /**
+             * @brief Run one ready job on this thread: a MAIN job if this is the main thread and one is ready, otherwise an ANY job.
+             *
+             * @return 0 if there was nothing to run.
+             */
+            bool runOne() {
+                Handle job;
+
+                if ((isMainThread() && takeMain(job)) || take(job)) {
+                    run(job);
+                    return 1;
+                }
+
+                return 0;
+            };
+
+            /**
+             * @brief Run the ready MAIN jobs. Only call from the main thread. Does not allocate when there are none.
+             *
+             * @param max Most jobs to run, to bound the time spent.
+             * @return Number of jobs run.
+             */
+            size_t runMainThreadJobs(size_t max = (size_t) -1) {
+                size_t n = 0;
+                Handle job;
+
+                while (n < max && takeMain(job)) {
+                    run(job);
+                    job.reset();
+                    n++;
+                }
+
+                return n;
+            };
+
+            // * Wait for a job, running other jobs meanwhile. A null handle returns at once.
+            void wait(Handle const &task) {
+                if (!task) { return; }
+
+                bool main = isMainThread();
+
+                while (!task->finished()) {
+                    if (runOne()) { continue; }
+
+                    std::unique_lock<std::mutex> lock(sleepMutex);
+                    sleepCv.wait_for(lock, std::chrono::milliseconds(1), [&] {
+                        return task->finished() || queued.load() > 0 || (main && mainQueued.load() > 0);
+                    });
+                }
+            };
+
+            // * Wait for every frame job submitted so far, and run the ready MAIN jobs. Call once per frame from the main thread.
+            void endFrame() {
+                {
+                    std::lock_guard<std::mutex> lock(frameMutex);
+                    frameWaiting.swap(frameJobs);
+                }
+
+                for (Handle const &task : frameWaiting) { wait(task); }
+                frameWaiting.clear();
+
+                runMainThreadJobs();
+            };
+    };
+
+    // * The job system shared by the whole program, with one worker per hardware thread besides the main thread.
+    // * Call it first from the main thread.
+    inline System& get() {
+        static System system(std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 1);
+        return system;
+    };
+}
+
+#endif // !JOBS_H
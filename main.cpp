@@ -1,80 +1,340 @@
 // ? Main file to manage menus, graphics, and string together mini-games.
 
-#include "trickshot.h"
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include "alloc.h"
+#include "analyzer.h"
+#include "generator.h"
+#include "scene.h"
+#include "trickshotgame.h"
+
+// Run the map difficulty analyser without opening a window and write <out>.csv and <out>.png.
+// With a cache path, shot results are loaded from and saved back to that file.
+int analyzeMap(const char* mappath, Analyzer::Options opt, std::string const &out, const char* cachePath, size_t cacheMB) {
+    TrickShot::Stage stage;
+    stage.loadMap(mappath);
+
+    std::unique_ptr<SimCache::Cache> cache;
+    if (cachePath) {
+        SimCache::Config config;
+        config.timeStep = opt.timeStep;
+        config.maxSteps = opt.maxSteps;
+
+        cache = std::make_unique<SimCache::Cache>(cacheMB << 20, config);
+        if (cache->load(cachePath)) { printf("Loaded %zu cached shots from %s.\n", cache->size(), cachePath); }
+        opt.cache = cache.get();
+    }
+
+    printf("Analysing %s: %u angles x %u powers x %u shots per tile...\n", mappath, opt.angles, opt.powers, opt.samples);
+    Analyzer::Result result = Analyzer::analyze(stage, opt);
+
+    printf("%llu shots on %u thread(s) in %.2fs (%.0f shots/s), solved in %.2fs.\n", (unsigned long long) result.shots,
+           result.threads, result.simulateSeconds, result.shots/result.simulateSeconds, result.solveSeconds);
+
+    std::string csv = out + ".csv", png = out + ".png";
+    bool ok = 1;
+
+    if (!Analyzer::writeCSV(result, stage, csv.c_str())) { fprintf(stderr, "Could not write '%s'.\n", csv.c_str()); ok = 0; }
+    if (!Analyzer::writePNG(result, stage, png.c_str())) { fprintf(stderr, "Could not write '%s'.\n", png.c_str()); ok = 0; }
+    if (ok) { printf("Wrote %s and %s.\n", csv.c_str(), png.c_str()); }
+
+    if (cache) {
+        printf("Shot cache: %llu hits, %llu misses, %zu/%zu entries.\n", (unsigned long long) cache->hits(),
+               (unsigned long long) cache->misses(), cache->size(), cache->capacity());
+
+        if (!cache->save(cachePath)) { fprintf(stderr, "Could not write '%s'.\n", cachePath); ok = 0; }
+    }
+
+    return ok ? 0 : 1;
+};
+
+// Generate a pack of validated levels without opening a window and write them to dir.
+int generateLevels(uint count, Generator::Params const &params, unsigned int threads, uint64_t seed, std::string const &dir) {
+    printf("Generating %u %ux%u levels with par %u-%u...\n", count, params.width, params.height, params.minPar, params.maxPar);
+
+    Generator::Stats stats;
+    std::vector<Generator::Level> levels = Generator::generate(params, count, threads, seed, stats);
+
+    size_t made = levels.size();
+    printf("%zu levels from %llu candidates (%.1f%% accepted) in %.2fs (%.0f levels/s, %.0f candidates/s).\n", made,
+           (unsigned long long) stats.candidates, 100.0*made/stats.candidates, stats.seconds, made/stats.seconds,
+           stats.candidates/stats.seconds);
+
+    if (!Generator::writePack(levels, dir)) {
+        fprintf(stderr, "Could not write the level pack to '%s'.\n", dir.c_str());
+        return 1;
+    }
+
+    printf("Wrote %s/pack.txt.\n", dir.c_str());
+
+    if (made < count) {
+        fprintf(stderr, "Gave up after %llu candidates with %zu of %u levels. Try a wider --par range or another --gen-size or --gen-tiles.\n",
+                (unsigned long long) stats.candidates, made, count);
+        return 1;
+    }
+
+    return 0;
+};
+
+// Run the headless physics regression checks on the stock stages. Returns 1 if any fails.
+int checkPhysics() {
+    static const uint ANGLES = 72, POWERS = 12, MAX_STEPS = 3000;
+    bool ok = 1;
+
+    for (uint m = 0; m < TrickShot::NUM_STAGES; ++m) {
+        TrickShot::Stage stage;
+        stage.loadMap(TrickShot::Game::MAP_PATHS[m]);
+        ZMath::Vec2D tee = stage.getBall().hitbox.c;
+
+        // a ball sent back by water stays on its tee, rather than sweeping from the water to the tee into the walls between:
+        //  the wall field march of its next step has to start from the tee, and the ball has to stay there
+        uint resets = 0, marchedFromWater = 0, strayed = 0;
+
+        for (uint a = 0; a < ANGLES; ++a) {
+            for (uint p = 0; p < POWERS; ++p) {
+                TrickShot::Ball ball = stage.getBall();
+                float power = 200.0f + 1400.0f*p/(POWERS - 1);
+                ball.vel = ZMath::Vec2D(power*ZMath::cosDeg(a*360.0f/ANGLES), power*ZMath::sinDeg(a*360.0f/ANGLES));
+                ball.canHit = 1;
+
+                for (uint s = 0; s < MAX_STEPS; ++s) {
+                    TrickShot::StepResult res = stage.step(ball, 0.0167f);
+                    if (res == TrickShot::MOVING) { continue; }
+                    if (res != TrickShot::WATER) { break; }
+
+                    resets++;
+                    if (ball.prevPos != tee || ball.hitbox.c != tee) { marchedFromWater++; }
+
+                    for (uint k = 0; k < 3; ++k) { stage.step(ball, 0.0167f); }
+                    if (ball.hitbox.c != tee) { strayed++; }
+                    break;
+                }
+            }
+        }
+
+        printf("%s: %u water resets, %u marched from the water, %u left the tee.\n", TrickShot::Game::MAP_PATHS[m], resets, marchedFromWater, strayed);
+        ok &= !marchedFromWater && !strayed;
+    }
+
+    printf(ok ? "All physics checks passed.\n" : "Physics checks FAILED.\n");
+    return ok ? 0 : 1;
+};
+
+int main(int argc, char** argv) {
+    // start the job system so this thread is its main thread
+    Jobs::get();
+    Arena::frame();
+
+    // Command line flags
+    // --trace <file> records frame phases to a Chrome trace_event JSON file.
+    // --alloc-audit fails (exit code 1) if any heap allocation happens on the main thread during steady-state frames.
+    // --players <n> sets the number of hot-seat players (1 to 8).
+    // --mem-report prints the memory used by each stage once they are loaded.
+    // --analyze <map> runs the Monte Carlo difficulty analyser on a map without opening a window, tuned with
+    //  --shots <n> (shots per aim and strength bin), --threads <n>, --seed <n>, and --out <prefix>.
+    //  --cache <file> memoises shot results in <file> across runs, using at most --cache-mb <n> megabytes (default 128).
+    // --check runs the headless physics regression checks on the stock stages and exits with code 1 if any fails.
+    // --generate <n> writes n validated procedural levels to --gen-dir <dir> (default generated) without opening a window,
+    //  shaped by --gen-size <w>x<h>, --gen-tiles <walls>,<panels>,<sand>,<water>, --gen-density <f>, and --par <min>-<max>.
+    //  --threads and --seed apply here too.
+    bool allocAudit = 0;
+    bool memReport = 0;
+    bool check = 0;
+    uint players = 1;
+    const char* analyzePath = nullptr;
+    Analyzer::Options analyzeOpt;
+    std::string analyzeOut = "difficulty";
+    const char* cachePath = nullptr;
+    size_t cacheMB = 128;
+
+    uint generateCount = 0;
+    Generator::Params generateParams;
+    std::string generateDir = "generated";
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--trace") && i + 1 < argc) {
+            if (!Trace::start(argv[++i])) { fprintf(stderr, "Could not open trace file '%s'.\n", argv[i]); }
+
+        } else if (!strcmp(argv[i], "--alloc-audit")) {
+            allocAudit = 1;
+
+        } else if (!strcmp(argv[i], "--players") && i + 1 < argc) {
+            players = (uint) atoi(argv[++i]);
+
+        } else if (!strcmp(argv[i], "--mem-report")) {
+            memReport = 1;
+
+        } else if (!strcmp(argv[i], "--analyze") && i + 1 < argc) {
+            analyzePath = argv[++i];
+
+        } else if (!strcmp(argv[i], "--shots") && i + 1 < argc) {
+            analyzeOpt.samples = (uint) atoi(argv[++i]);
+
+        } else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+            analyzeOpt.threads = (unsigned int) atoi(argv[++i]);
+
+        } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+            analyzeOpt.seed = strtoull(argv[++i], nullptr, 10);
+
+        } else if (!strcmp(argv[i], "--out") && i + 1 < argc) {
+            analyzeOut = argv[++i];
+
+        } else if (!strcmp(argv[i], "--cache") && i + 1 < argc) {
+            cachePath = argv[++i];
+
+        } else if (!strcmp(argv[i], "--cache-mb") && i + 1 < argc) {
+            cacheMB = (size_t) atoi(argv[++i]);
+
+        } else if (!strcmp(argv[i], "--check")) {
+            check = 1;
+
+        } else if (!strcmp(argv[i], "--generate") && i + 1 < argc) {
+            generateCount = (uint) atoi(argv[++i]);
+
+        } else if (!strcmp(argv[i], "--gen-size") && i + 1 < argc) {
+            sscanf(argv[++i], "%ux%u", &generateParams.width, &generateParams.height);
+
+        } else if (!strcmp(argv[i], "--gen-tiles") && i + 1 < argc) {
+            sscanf(argv[++i], "%d,%d,%d,%d", &generateParams.walls, &generateParams.panels, &generateParams.sand, &generateParams.water);
+
+        } else if (!strcmp(argv[i], "--gen-density") && i + 1 < argc) {
+            generateParams.hazardDensity = (float) atof(argv[++i]);
+
+        } else if (!strcmp(argv[i], "--par") && i + 1 < argc) {
+            sscanf(argv[++i], "%u-%u", &generateParams.minPar, &generateParams.maxPar);
+
+        } else if (!strcmp(argv[i], "--gen-dir") && i + 1 < argc) {
+            generateDir = argv[++i];
+        }
+    }
+
+    if (analyzePath) {
+        int code = analyzeMap(analyzePath, analyzeOpt, analyzeOut, cachePath, cacheMB);
+        Trace::stop();
+        return code;
+    }
+
+    if (check) {
+        int code = checkPhysics();
+        Trace::stop();
+        return code;
+    }
+
+    if (generateCount) {
+        if (generateParams.width < 8 || generateParams.height < 8 || generateParams.width > 112 || generateParams.height > 56) {
+            fprintf(stderr, "--gen-size must be between 8x8 and 112x56.\n");
+            return 1;
+        }
+
+        if (generateParams.minPar < 1 || generateParams.minPar > generateParams.maxPar) {
+            fprintf(stderr, "--par must be <min>-<max> with 1 <= min <= max.\n");
+            return 1;
+        }
+
+        int code = generateLevels(generateCount, generateParams, analyzeOpt.threads, analyzeOpt.seed, generateDir);
+        Trace::stop();
+        return code;
+    }
 
-int main() {
     // Initialization
     static const int screenWidth = 1800;
     static const int screenHeight = 900;
 
-    InitWindow(screenWidth, screenHeight, "Mini-Game Mayham");
-
-
-    int currStage = 0;
-    TrickShot::Stage stages[5];
+    {
+        TRACE_SCOPE("InitWindow", "load");
+        InitWindow(screenWidth, screenHeight, "Mini-Game Mayham");
+    }
 
-    stages[0].init("assets/maps/map1.map");
-    stages[1].init("assets/maps/map2.map");
-    stages[2].init("assets/maps/map3.map");
-    stages[3].init("assets/maps/map4.map");
-    stages[4].init("assets/maps/map5.map");
+    // mini-games are loaded a few steps per frame when switched to, and unloaded when switched away from
+    Scene::Manager scenes;
+    TrickShot::Game* trickshot = scenes.add(std::make_unique<TrickShot::Game>(players));
+    scenes.switchTo(0);
 
-    // used to track delta mouse
-    ZMath::Vec2D startMPos;
+    bool memReported = 0;
 
-    // dt stuff
-    float dt = 0.0f;
-    float timeStep = 0.0167f;
+    // memory overlay toggled with F3
+    bool showMem = 0;
+    char memText[2048];
 
-    // flag bool used to determine if the player can input
-    bool flag = 1;
+    // allocation audit
+    // Frames before auditStart are warm up (including loading). A shot is fired on auditStart so physics and HUD updates are covered.
+    static const uint auditStart = 120;
+    static const uint auditEnd = 720;
+    uint frame = 0;
+    uint64_t auditAllocs = 0;
 
     // Main game loop
     while (!WindowShouldClose()) {
+        TRACE_SCOPE("frame", "frame");
+        uint64_t frameAllocs = Alloc::count();
+
+        if (allocAudit && frame == auditStart) { trickshot->stage().shoot(ZMath::Vec2D(400.0f, 150.0f)); }
 
         // * Update
-        while(dt >= timeStep) {
-            // update the trickshot stage
-            flag = stages[currStage].update(timeStep);
+        scenes.update(GetFrameTime());
 
-            dt -= timeStep;
-        }
+        // finish this frame's jobs and run queued main thread (GL) jobs
+        Jobs::get().endFrame();
 
-        // check for mouse dragging
-        if (flag) {
-            if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-                startMPos.x = GetMouseX();
-                startMPos.y = GetMouseY();
-            }
+        MiniGame* game = scenes.current();
 
-            if (IsMouseButtonReleased(MOUSE_BUTTON_LEFT)) {
-                ZMath::Vec2D dP = ZMath::Vec2D(startMPos.x - GetMouseX(), startMPos.y - GetMouseY());
-                if (dP.magSq() >= 550.0f) { stages[currStage].shoot(dP); }
-            }
+        if (memReport && !memReported && game) {
+            game->formatMemory(memText, sizeof(memText));
+            fputs(memText, stdout);
+            memReported = 1;
         }
 
-        if (stages[currStage].complete && IsMouseButtonReleased(MOUSE_BUTTON_LEFT)) {
-            currStage++;
-            if (currStage == 5) {
-                for (int i = 0; i < 5; ++i) { stages[i].reset(); }
-                currStage = 0;
-            }
+        if (IsKeyPressed(KEY_F3)) {
+            showMem = !showMem;
+            if (showMem && game) { game->formatMemory(memText, sizeof(memText)); }
+            else if (showMem) { snprintf(memText, sizeof(memText), "loading...\n"); }
         }
 
         // * Draw
-        BeginDrawing();
+        {
+            TRACE_SCOPE("draw", "render");
 
-            ClearBackground(BLACK);
+            BeginDrawing();
 
-            stages[currStage].draw();
+                ClearBackground(BLACK);
 
-            DrawFPS(10, 50);
+                scenes.draw();
 
-        EndDrawing();
+                DrawFPS(10, 50);
 
-        dt += GetFrameTime();
+                if (showMem) { DrawText(memText, 10, 80, 10, YELLOW); }
+        }
+
+        {
+            // EndDrawing swaps the buffers and polls input events.
+            TRACE_SCOPE("swap", "render");
+            EndDrawing();
+        }
+
+        // everything drawn this frame is done with its temporaries
+        Arena::frame().reset();
+
+        if (allocAudit && frame >= auditStart) {
+            frameAllocs = Alloc::count() - frameAllocs;
+            if (frameAllocs) { fprintf(stderr, "alloc audit: frame %u made %llu allocation(s).\n", frame, (unsigned long long) frameAllocs); }
+            auditAllocs += frameAllocs;
+
+            if (frame + 1 == auditEnd) { break; }
+        }
+
+        frame++;
     }
 
+    scenes.close();
     CloseWindow();
+    Trace::stop();
+
+    if (allocAudit) {
+        printf("alloc audit: %llu allocation(s) in %u steady-state frames.\n", (unsigned long long) auditAllocs, auditEnd - auditStart);
+        return auditAllocs ? 1 : 0;
+    }
+
     return 0;
 };
@@ -0,0 +1,44 @@
+#ifndef MEMREPORT_H
+#define MEMREPORT_H
+
+#include <cstdio>
+#include "trickshot.h"
+
+// * ======================================
+// * Memory Accounting Report
+// * ======================================
+
+namespace MemReport {
+    // * Format a per-stage and total breakdown of the memory used by the stages into buf.
+    // * Nothing is allocated, so this is safe to call from the main loop.
+    inline void format(char* buf, size_t size, TrickShot::Stage const* stages, uint numStages) {
+        int n = snprintf(buf, size, "%-8s %10s %10s %10s %10s %10s %12s\n", "stage", "grid", "colliders", "images*", "textures", "overhead", "resident");
+        TrickShot::MemoryUsage total;
+
+        for (uint i = 0; i < numStages && n >= 0 && (size_t) n < size; ++i) {
+            TrickShot::MemoryUsage mem = stages[i].memoryUsage();
+            total += mem;
+
+            n += snprintf(buf + n, size - n, "%-8u %10zu %10zu %10zu %10zu %10zu %12zu\n",
+                          i + 1, mem.grid, mem.colliders, mem.images, mem.textures, mem.overhead, mem.resident());
+        }
+
+        if (n >= 0 && (size_t) n < size) {
+            n += snprintf(buf + n, size - n, "%-8s %10zu %10zu %10zu %10zu %10zu %12zu\n",
+                          "total", total.grid, total.colliders, total.images, total.textures, total.overhead, total.resident());
+        }
+
+        if (n >= 0 && (size_t) n < size) {
+            snprintf(buf + n, size - n, "* decoded images are freed after upload; this is the peak during init (bytes).\n");
+        }
+    };
+
+    // * Print the report to a file (stdout by default).
+    inline void print(TrickShot::Stage const* stages, uint numStages, FILE* out = stdout) {
+        char buf[2048];
+        format(buf, sizeof(buf), stages, numStages);
+        fputs(buf, out);
+    };
+}
+
+#endif // !MEMREPORT_H
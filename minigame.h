@@ -0,0 +1,54 @@
+#ifndef MINIGAME_H
+#define MINIGAME_H
+
+#include <cstddef>
+
+// * =====================================
+// * Mini-Game Interface
+// * =====================================
+
+// ? Every mini-game implements this so the scene manager can load, run, and unload it without knowing what it is.
+// ? Loading is split into steps so the manager can spread it over several frames within a time budget, and a game
+// ?  only holds its assets between finishing loading and unload().
+
+class MiniGame {
+    public:
+        virtual ~MiniGame() {};
+
+        // Name shown while the game is loading.
+        virtual const char* name() const = 0;
+
+        /**
+         * @brief Do the next piece of loading. Called once or more per frame until it returns 1.
+         *        Each call should do a small, bounded amount of work (such as loading one level) so frames stay short.
+         *
+         * @return 1 once the game is fully loaded.
+         */
+        virtual bool load() = 0;
+
+        /**
+         * @brief Advance the game by one fixed physics step.
+         *
+         * @param dt The time step. This is the same every call for determinism.
+         */
+        virtual void step(float dt) = 0;
+
+        // Handle input and anything else done once per frame, after the physics steps.
+        virtual void update() = 0;
+
+        // Draw the game. Called between BeginDrawing and EndDrawing.
+        virtual void draw() const = 0;
+
+        // Free every asset so only the active game's are resident. load() must work again afterwards.
+        virtual void unload() = 0;
+
+        // Has the player finished the game, so the manager should move on to the next one.
+        virtual bool finished() const { return 0; };
+
+        // Write a memory report into buf. Must not allocate, as it can be called from the main loop.
+        virtual void formatMemory(char* buf, size_t size) const {
+            if (size) { buf[0] = '\0'; }
+        };
+};
+
+#endif // !MINIGAME_H
@@ -0,0 +1,77 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+#include "jobs.h"
+
+// * =====================================
+// * Parallel Loops
+// * =====================================
+
+namespace Parallel {
+    // * Number of hardware threads, or 1 if it cannot be determined.
+    inline unsigned int hardwareThreads() {
+        unsigned int n = std::thread::hardware_concurrency();
+        return n ? n : 1;
+    };
+
+    /**
+     * @brief Most threads forEach runs n indices on: the request, capped by n and by the job system's workers plus the
+     *        calling thread.
+     *
+     * @param n Number of indices.
+     * @param threads Threads asked for. 0 asks for every hardware thread.
+     */
+    inline unsigned int threadsUsed(size_t n, unsigned int threads) {
+        if (!threads) { threads = hardwareThreads(); }
+        if (threads > n) { threads = n ? (unsigned int) n : 1; }
+        if (threads == 1) { return 1; }
+
+        size_t pool = Jobs::get().numWorkers() + 1;
+        return threads < pool ? threads : (unsigned int) pool;
+    };
+
+    /**
+     * @brief Call fn(i) for every i in [0, n) on the job system. Returns once every call has finished.
+     *        Indices are handed out in chunks from a shared counter, so uneven work balances itself across threads.
+     *        The calling thread takes part, and may itself be a job.
+     *
+     * @param n Number of indices.
+     * @param threads Most threads to use including the calling thread. 0 uses every hardware thread. The job system's
+     *                pool size also caps it.
+     * @param fn Function taking a size_t index. It is called concurrently, so it must only write to state owned by that index.
+     * @param chunk Number of consecutive indices a thread takes at a time.
+     */
+    template <typename Fn>
+    void forEach(size_t n, unsigned int threads, Fn const &fn, size_t chunk = 1) {
+        threads = threadsUsed(n, threads);
+
+        std::atomic<size_t> nextIndex(0);
+
+        auto work = [&]() {
+            for (size_t start = nextIndex.fetch_add(chunk); start < n; start = nextIndex.fetch_add(chunk)) {
+                size_t end = start + chunk < n ? start + chunk : n;
+                for (size_t i = start; i < end; ++i) { fn(i); }
+            }
+        };
+
+        if (threads == 1) {
+            work();
+            return;
+        }
+
+        Jobs::System &jobs = Jobs::get();
+        std::vector<Jobs::Handle> helpers;
+        helpers.reserve(threads - 1);
+
+        for (unsigned int t = 1; t < threads; ++t) { helpers.push_back(jobs.submit(work)); }
+        work();
+
+        for (Jobs::Handle const &h : helpers) { jobs.wait(h); }
+    };
+}
+
+#endif // !PARALLEL_H
@@ -19,7 +19,7 @@ namespace Physics {
              * @param origin The origin of the ray.
              * @param dir The direction of the ray as a normalized vector.
              */
-            Ray2D(const ZMath::Vec2D &origin, const ZMath::Vec2D &dir) : origin(origin), dir(dir) {};
+            constexpr Ray2D(const ZMath::Vec2D &origin, const ZMath::Vec2D &dir) : origin(origin), dir(dir) {};
     };
 
     class Line2D {
@@ -32,10 +32,10 @@ namespace Physics {
              * @param start Starting point.
              * @param end Ending point.
              */
-            Line2D(ZMath::Vec2D const &start, ZMath::Vec2D const &end) : start(start), end(end) {};
+            constexpr Line2D(ZMath::Vec2D const &start, ZMath::Vec2D const &end) : start(start), end(end) {};
 
-            inline ZMath::Vec2D getMin() const { return ZMath::Vec2D(ZMath::min(start.x, end.x), ZMath::min(start.y, end.y)); };
-            inline ZMath::Vec2D getMax() const { return ZMath::Vec2D(ZMath::max(start.x, end.x), ZMath::max(start.y, end.y)); };
+            constexpr ZMath::Vec2D getMin() const { return ZMath::Vec2D(ZMath::min(start.x, end.x), ZMath::min(start.y, end.y)); };
+            constexpr ZMath::Vec2D getMax() const { return ZMath::Vec2D(ZMath::max(start.x, end.x), ZMath::max(start.y, end.y)); };
     };
 
     class Circle {
@@ -45,7 +45,7 @@ namespace Physics {
 
             Circle() = default; // to make the compiler happy (and make the program faster)
 
-            Circle(ZMath::Vec2D const &center, float radius) : c(center), r(radius) {};
+            constexpr Circle(ZMath::Vec2D const &center, float radius) : c(center), r(radius) {};
     };
 
     class AABB {
@@ -63,11 +63,11 @@ namespace Physics {
              * @param min The min vertex of the AABB.
              * @param max The max vertex of the AABB.
              */
-            AABB(const ZMath::Vec2D &min, const ZMath::Vec2D &max) : halfsize((max - min) * 0.5f), pos(min + halfsize) {};
+            constexpr AABB(const ZMath::Vec2D &min, const ZMath::Vec2D &max) : halfsize((max - min) * 0.5f), pos(min + halfsize) {};
 
-            ZMath::Vec2D getMin() const { return pos - halfsize; };
-            ZMath::Vec2D getMax() const { return pos + halfsize; };
-            ZMath::Vec2D getHalfsize() const { return halfsize; };
+            constexpr ZMath::Vec2D getMin() const { return pos - halfsize; };
+            constexpr ZMath::Vec2D getMax() const { return pos + halfsize; };
+            constexpr ZMath::Vec2D getHalfsize() const { return halfsize; };
 
             // Get the vertices of the AABB.
             // Remember to call delete[] afterwards to free the memory.
@@ -106,12 +106,20 @@ namespace Physics {
              * @param max 
              * @param theta 
              */
-            Box2D(ZMath::Vec2D const &min, ZMath::Vec2D const &max, float theta) : 
-                    halfsize((max - min) * 0.5f), pos(min + halfsize), theta(theta) { rot = ZMath::Mat2D::rotationMat(theta); };
+            constexpr Box2D(ZMath::Vec2D const &min, ZMath::Vec2D const &max, float theta) : 
+                    halfsize((max - min) * 0.5f), pos(min + halfsize), theta(theta), rot(ZMath::Mat2D::rotationMat(theta)) {};
 
-            ZMath::Vec2D getLocalMin() const { return pos - halfsize; };
-            ZMath::Vec2D getLocalMax() const { return pos + halfsize; };
-            ZMath::Vec2D getHalfsize() const { return halfsize; };
+            constexpr ZMath::Vec2D getLocalMin() const { return pos - halfsize; };
+            constexpr ZMath::Vec2D getLocalMax() const { return pos + halfsize; };
+            constexpr ZMath::Vec2D getHalfsize() const { return halfsize; };
+
+            // Get the smallest AABB containing the Box2D.
+            constexpr AABB getBounds() const {
+                ZMath::Vec2D e(ZMath::abs(rot.c1.x)*halfsize.x + ZMath::abs(rot.c2.x)*halfsize.y,
+                               ZMath::abs(rot.c1.y)*halfsize.x + ZMath::abs(rot.c2.y)*halfsize.y);
+
+                return AABB(pos - e, pos + e);
+            };
 
             // Get the vertices of the Box2D.
             // Remember to call delete[] on it.
@@ -181,32 +189,96 @@ namespace Physics {
     };
 
     // Normal points away from A towards B.
-    // Normal will be a junk value if no collision occurs.
-    bool CircleAndAABB(const Circle &c, const AABB &a, ZMath::Vec2D &normal) {
+    // Depth is how far the circle must move against the normal to stop touching the AABB.
+    // Normal and depth will be junk values if no collision occurs.
+    bool CircleAndAABB(const Circle &c, const AABB &a, ZMath::Vec2D &normal, float &depth) {
         // ? Determine the closest point of the AABB to the Circle and check if its distance to the center is less than the radius.
+        // ? If the center is inside the AABB the circle leaves through the nearest face.
 
-        ZMath::Vec2D closest = c.c;
         ZMath::Vec2D min = a.getMin(), max = a.getMax();
+        ZMath::Vec2D diff = ZMath::clamp(c.c, min, max) - c.c;
 
-        closest = ZMath::clamp(closest, min, max);
-        ZMath::Vec2D diff = closest - c.c;
+        float distSq = diff.magSq();
+        if (distSq > c.r*c.r) { return 0; }
 
-        if (diff.magSq() > c.r*c.r) { return 0; }
+        if (distSq > 0.0f) {
+            float dist = ZMath::sqrt(distSq);
+            normal = diff * (1.0f/dist);
+            depth = c.r - dist;
+            return 1;
+        }
+
+        ZMath::Vec2D h = a.getHalfsize(), local = c.c - a.pos;
+        float dx = h.x - ZMath::abs(local.x), dy = h.y - ZMath::abs(local.y);
+
+        if (dx < dy) {
+            normal = ZMath::Vec2D(local.x < 0.0f ? 1.0f : -1.0f, 0.0f);
+            depth = dx + c.r;
+
+        } else {
+            normal = ZMath::Vec2D(0.0f, local.y < 0.0f ? 1.0f : -1.0f);
+            depth = dy + c.r;
+        }
 
-        normal = diff.normalize();
         return 1;
     };
 
+    // Normal points away from A towards B.
+    // Normal will be a junk value if no collision occurs.
+    bool CircleAndAABB(const Circle &c, const AABB &a, ZMath::Vec2D &normal) {
+        float depth;
+        return CircleAndAABB(c, a, normal, depth);
+    };
+
     bool CircleAndBox2D(const Circle &c, const Box2D &b) {
         // ? Same as CircleAndAABB except we first rotate the circle into the box's local space.
 
-        ZMath::Vec2D closest = c.c - b.pos;
-        ZMath::Vec2D min = b.getLocalMin(), max = b.getLocalMax();
+        ZMath::Vec2D center = b.rot.transpose() * (c.c - b.pos) + b.pos;
+        ZMath::Vec2D closest = ZMath::clamp(center, b.getLocalMin(), b.getLocalMax());
 
-        closest = b.rot.transpose() * closest + b.pos;
-        closest = ZMath::clamp(closest, min, max);
+        return closest.distSq(center) <= c.r*c.r;
+    };
 
-        return closest.distSq(c.c) <= c.r*c.r;
+    // Normal points away from A towards B.
+    // Depth is how far the circle must move against the normal to stop touching the box.
+    // Normal and depth will be junk values if no collision occurs.
+    bool CircleAndBox2D(const Circle &c, const Box2D &b, ZMath::Vec2D &normal, float &depth) {
+        // ? Find the closest point in the box's local space, where it is an AABB centered on the origin, then rotate the
+        // ?  normal back. If the center is inside the box the circle leaves through the nearest face.
+
+        ZMath::Vec2D h = b.getHalfsize();
+        ZMath::Vec2D local = b.rot.transpose() * (c.c - b.pos);
+        ZMath::Vec2D diff = ZMath::clamp(local, -h, h) - local;
+
+        float distSq = diff.magSq();
+        if (distSq > c.r*c.r) { return 0; }
+
+        if (distSq > 0.0f) {
+            float dist = ZMath::sqrt(distSq);
+            normal = b.rot * (diff * (1.0f/dist));
+            depth = c.r - dist;
+            return 1;
+        }
+
+        float dx = h.x - ZMath::abs(local.x), dy = h.y - ZMath::abs(local.y);
+
+        if (dx < dy) {
+            normal = b.rot * ZMath::Vec2D(local.x < 0.0f ? 1.0f : -1.0f, 0.0f);
+            depth = dx + c.r;
+
+        } else {
+            normal = b.rot * ZMath::Vec2D(0.0f, local.y < 0.0f ? 1.0f : -1.0f);
+            depth = dy + c.r;
+        }
+
+        return 1;
+    };
+
+    // Normal points away from A towards B.
+    // Normal will be a junk value if no collision occurs.
+    bool CircleAndBox2D(const Circle &c, const Box2D &b, ZMath::Vec2D &normal) {
+        float depth;
+        return CircleAndBox2D(c, b, normal, depth);
     };
 
 
@@ -265,6 +337,75 @@ namespace Physics {
         return 1;
     };
 
+    // * Where a ray first hits a solid cell of a grid.
+    struct RayHit {
+        float dist = -1.0f; // distance along the ray. -1 if nothing was hit.
+        ZMath::Vec2D point; // where the ray entered the cell.
+        ZMath::Vec2D normal; // outward normal of the face it entered through.
+        int row = -1, col = -1; // the cell hit.
+    };
+
+    /**
+     * @brief Find the first solid cell of a uniform grid along a ray.
+     *        The ray walks the cells it passes through in order (Amanatides-Woo), so this costs one step per cell crossed
+     *        however many solid cells there are.
+     * 
+     * @param ray 2D ray, starting inside the grid.
+     * @param origin Position of the top left corner of the grid.
+     * @param cellSize Size of a cell.
+     * @param cols Number of columns.
+     * @param rows Number of rows.
+     * @param solid solid(row, col) tells if a cell stops the ray.
+     * @param maxDist Cells further than this along the ray are not checked.
+     * @param hit Set to the first hit. Its dist is -1 if there is none.
+     * @return Is there a hit? A ray starting in a solid cell or outside the grid does not hit anything.
+     */
+    template <typename Solid>
+    bool raycast(Ray2D const &ray, ZMath::Vec2D const &origin, float cellSize, int cols, int rows, Solid const &solid, float maxDist, RayHit &hit) {
+        hit.dist = -1.0f;
+
+        ZMath::Vec2D p = (ray.origin - origin) * (1.0f/cellSize);
+        if (p.x < 0.0f || p.y < 0.0f || p.x >= cols || p.y >= rows) { return 0; }
+
+        int col = (int) p.x, row = (int) p.y;
+        if (solid(row, col)) { return 0; }
+
+        int stepX = ray.dir.x < 0.0f ? -1 : 1, stepY = ray.dir.y < 0.0f ? -1 : 1;
+
+        // distance along the ray to the next column and row lines, and between consecutive ones
+        float deltaX = ray.dir.x != 0.0f ? cellSize/ZMath::abs(ray.dir.x) : INFINITY;
+        float deltaY = ray.dir.y != 0.0f ? cellSize/ZMath::abs(ray.dir.y) : INFINITY;
+        float nextX = ray.dir.x != 0.0f ? (origin.x + (col + (stepX > 0)) * cellSize - ray.origin.x)/ray.dir.x : INFINITY;
+        float nextY = ray.dir.y != 0.0f ? (origin.y + (row + (stepY > 0)) * cellSize - ray.origin.y)/ray.dir.y : INFINITY;
+
+        while (1) {
+            float t;
+
+            if (nextX < nextY) {
+                t = nextX;
+                col += stepX;
+                nextX += deltaX;
+                hit.normal = ZMath::Vec2D((float) -stepX, 0.0f);
+
+            } else {
+                t = nextY;
+                row += stepY;
+                nextY += deltaY;
+                hit.normal = ZMath::Vec2D(0.0f, (float) -stepY);
+            }
+
+            if (t > maxDist || col < 0 || row < 0 || col >= cols || row >= rows) { return 0; }
+
+            if (solid(row, col)) {
+                hit.dist = t;
+                hit.point = ray.origin + ray.dir * t;
+                hit.row = row;
+                hit.col = col;
+                return 1;
+            }
+        }
+    };
+
     // todo add circle vs AABB as that might be better than the raycasting method
 }
 
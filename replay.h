@@ -0,0 +1,139 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstddef>
+#include <cstdint>
+
+// * =====================================
+// * Compact Run Recording
+// * =====================================
+
+// ? The physics step is deterministic, so a run is stored as just its shots: the physics step each one was taken on and
+// ?  the whole-pixel drag. Playing a run back re-simulates it, which reproduces the trajectory exactly.
+// ? Each shot is encoded as the steps since the previous shot followed by the drag, all as LEB128 variable-length
+// ?  integers (the drag zigzag encoded). A typical shot takes 5 or 6 bytes, so a run fits in a fixed buffer of a few
+// ?  hundred bytes with no allocation. Runs with more shots than fit are marked as truncated.
+
+namespace Replay {
+    static const size_t RUN_BYTES = 256; // storage per run.
+
+    // * Map signed integers to unsigned ones so values near 0 stay small: 0, -1, 1, -2, ... -> 0, 1, 2, 3, ...
+    constexpr uint32_t zigzag(int32_t v) { return ((uint32_t) v << 1) ^ (uint32_t) (v >> 31); };
+    constexpr int32_t unzigzag(uint32_t v) { return (int32_t) (v >> 1) ^ -(int32_t) (v & 1); };
+
+    class Run {
+        private:
+            uint8_t data[RUN_BYTES];
+            uint16_t length = 0; // bytes used.
+            uint16_t numShots = 0;
+            uint32_t lastShot = 0; // step of the last shot recorded.
+            uint32_t endStep = 0; // step the ball was sunk on.
+            bool truncated = 0;
+            bool finished = 0;
+
+            // Append a variable-length integer. Returns 0 (leaving the run unchanged) if it does not fit.
+            bool put(uint32_t v, uint16_t &at) {
+                do {
+                    if (at >= RUN_BYTES) { return 0; }
+
+                    data[at++] = (v & 0x7f) | (v > 0x7f ? 0x80 : 0);
+                    v >>= 7;
+                } while (v);
+
+                return 1;
+            };
+
+            friend class Reader;
+
+        public:
+            // * Forget every shot so a new run can be recorded.
+            inline void clear() {
+                length = numShots = 0;
+                lastShot = endStep = 0;
+                truncated = finished = 0;
+            };
+
+            /**
+             * @brief Record a shot.
+             *
+             * @param step Physics step the shot was taken before. Must not be earlier than the previous shot's.
+             * @param dx Horizontal drag in whole pixels.
+             * @param dy Vertical drag in whole pixels.
+             * @return 0 if the run is full, in which case it is marked as truncated.
+             */
+            bool record(uint32_t step, int32_t dx, int32_t dy) {
+                if (truncated) { return 0; }
+
+                uint16_t at = length;
+                if (!put(step - lastShot, at) || !put(zigzag(dx), at) || !put(zigzag(dy), at)) {
+                    truncated = 1;
+                    return 0;
+                }
+
+                length = at;
+                numShots++;
+                lastShot = step;
+                return 1;
+            };
+
+            // * Mark the run as finished with the ball sunk on a step.
+            inline void finish(uint32_t step) {
+                endStep = step;
+                finished = 1;
+            };
+
+            // * Was the run finished without being truncated. Only complete runs can be played back to the end.
+            inline bool complete() const { return finished && !truncated; };
+
+            inline unsigned int shots() const { return numShots; };
+            inline uint32_t steps() const { return endStep; };
+            inline size_t bytes() const { return length; };
+
+            // * Is this run better than another: fewer shots, then sunk sooner.
+            inline bool betterThan(Run const &run) const {
+                return numShots < run.numShots || (numShots == run.numShots && endStep < run.endStep);
+            };
+    };
+
+    // * Decodes the shots of a run in order.
+    class Reader {
+        private:
+            Run const* run = nullptr;
+            uint16_t at = 0;
+            uint32_t step = 0;
+
+            bool get(uint32_t &v) {
+                v = 0;
+
+                for (int shift = 0; at < run->length; shift += 7) {
+                    uint8_t b = run->data[at++];
+                    v |= (uint32_t) (b & 0x7f) << shift;
+                    if (!(b & 0x80)) { return 1; }
+                }
+
+                return 0;
+            };
+
+        public:
+            Reader() {};
+            Reader(Run const &run) : run(&run) {};
+
+            /**
+             * @brief Decode the next shot.
+             *
+             * @return 0 once every shot has been read.
+             */
+            bool next(uint32_t &shotStep, int32_t &dx, int32_t &dy) {
+                uint32_t delta, x, y;
+                if (!run || !get(delta) || !get(x) || !get(y)) { return 0; }
+
+                step += delta;
+                shotStep = step;
+                dx = unzigzag(x);
+                dy = unzigzag(y);
+                return 1;
+            };
+    };
+}
+
+#endif // !REPLAY_H
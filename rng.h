@@ -0,0 +1,63 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <cstdint>
+
+// * =====================================
+// * Splittable Random Number Generator
+// * =====================================
+
+// ? SplitMix64 (Steele, Lea, and Flood, "Fast Splittable Pseudorandom Number Generators").
+// ? split() derives an independent generator, so work can be handed to threads with one generator each while the
+// ?  results stay the same for a given seed no matter how many threads run or in which order they finish.
+
+namespace Random {
+    static const uint64_t GOLDEN_GAMMA = 0x9e3779b97f4a7c15ull;
+
+    // * Stafford's variant 13 of the MurmurHash3 finalizer.
+    constexpr uint64_t mix64(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    };
+
+    // * Make a gamma (stream increment) from a seed. It must be odd and its bits should not be too regular.
+    constexpr uint64_t mixGamma(uint64_t z) {
+        z = mix64(z) | 1ull;
+
+        int transitions = 0;
+        for (uint64_t t = z ^ (z >> 1); t; t &= t - 1) { ++transitions; }
+
+        return transitions < 24 ? z ^ 0xaaaaaaaaaaaaaaaaull : z;
+    };
+
+    class Rng {
+        private:
+            uint64_t seed;
+            uint64_t gamma;
+
+            constexpr Rng(uint64_t seed, uint64_t gamma) : seed(seed), gamma(gamma) {};
+
+            constexpr uint64_t nextSeed() { return seed += gamma; };
+
+        public:
+            constexpr Rng(uint64_t seed = 0) : seed(seed), gamma(GOLDEN_GAMMA) {};
+
+            // * Derive an independent generator. This also advances this generator.
+            constexpr Rng split() {
+                uint64_t s = mix64(nextSeed());
+                return Rng(s, mixGamma(nextSeed()));
+            };
+
+            // * Next 64 random bits.
+            constexpr uint64_t next() { return mix64(nextSeed()); };
+
+            // * Uniform float in [0, 1) with 24 random bits.
+            constexpr float nextFloat() { return (next() >> 40) * (1.0f / 16777216.0f); };
+
+            // * Uniform float in [lo, hi).
+            constexpr float range(float lo, float hi) { return lo + (hi - lo) * nextFloat(); };
+    };
+}
+
+#endif // !RNG_H
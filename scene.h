@@ -0,0 +1,178 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <chrono>
+#include <memory>
+#include <vector>
+#include "raylib.h"
+#include "minigame.h"
+#include "trace.h"
+
+// * =====================================
+// * Scene Manager
+// * =====================================
+
+// ? Runs one mini-game at a time. Switching fades the old game out, unloads it, loads the new one a few steps per frame
+// ?  within a time budget (drawing a loading screen meanwhile), then fades the new game in.
+// ? Only the active game is loaded, so memory is bounded by the largest game rather than the sum of them.
+// ? Physics runs at a fixed time step from an accumulator, the same for every game.
+
+namespace Scene {
+    enum Phase {
+        IDLE, // no game selected.
+        FADE_OUT, // the old game is fading out.
+        LOADING, // the new game is loading.
+        FADE_IN, // the new game is fading in.
+        PLAYING
+    };
+
+    class Manager {
+        private:
+            std::vector<std::unique_ptr<MiniGame>> games;
+            int active = -1; // game being played or faded out.
+            int next = -1; // game being switched to.
+
+            Phase phase = IDLE;
+            float fade = 0.0f; // opacity of the black overlay.
+            float accumulator = 0.0f; // time not yet simulated.
+
+            // Start loading the next game once the old one is unloaded.
+            void beginLoading() {
+                if (active >= 0) { games[active]->unload(); }
+
+                active = next;
+                next = -1;
+                phase = LOADING;
+                fade = 1.0f;
+            };
+
+        public:
+            float timeStep = 0.0167f; // physics step passed to MiniGame::step.
+            float fadeTime = 0.25f; // seconds each fade takes.
+            double loadBudget = 0.008; // seconds per frame spent loading.
+
+            Manager() {};
+
+            Manager(Manager const &) = delete;
+            Manager& operator = (Manager const &) = delete;
+
+            ~Manager() { close(); };
+
+            // * Unload the active game. Call before closing the window, as unloading frees GPU resources.
+            void close() {
+                if (active >= 0) { games[active]->unload(); }
+
+                active = next = -1;
+                phase = IDLE;
+            };
+
+            /**
+             * @brief Add a mini-game. It is not loaded until it is switched to.
+             *
+             * @return The game, for callers that need its concrete type.
+             */
+            template <typename Game>
+            Game* add(std::unique_ptr<Game> game) {
+                Game* g = game.get();
+                games.push_back(std::move(game));
+                return g;
+            };
+
+            inline size_t size() const { return games.size(); };
+
+            // * Switch to a game. The current one fades out and is unloaded first.
+            void switchTo(size_t index) {
+                next = (int) index;
+
+                if (active < 0) { beginLoading(); }
+                else if (phase != FADE_OUT) { phase = FADE_OUT; }
+            };
+
+            // * The game being played, or nullptr while switching.
+            inline MiniGame* current() const { return phase == PLAYING ? games[active].get() : nullptr; };
+
+            // * Is a game being loaded or faded.
+            inline bool switching() const { return phase != PLAYING && phase != IDLE; };
+
+            /**
+             * @brief Run one frame: fixed physics steps and per-frame updates for the active game, or the next part of a switch.
+             *
+             * @param frameTime Seconds since the last frame.
+             */
+            void update(float frameTime) {
+                switch (phase) {
+                    case IDLE: { break; }
+
+                    case FADE_OUT: {
+                        fade += frameTime/fadeTime;
+                        if (fade >= 1.0f) { beginLoading(); }
+                        break;
+                    }
+
+                    case LOADING: {
+                        TRACE_SCOPE("load", "load");
+
+                        auto start = std::chrono::steady_clock::now();
+                        bool done = 0;
+
+                        do { done = games[active]->load(); }
+                        while (!done && std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < loadBudget);
+
+                        if (done) { phase = FADE_IN; }
+                        break;
+                    }
+
+                    case FADE_IN: {
+                        fade -= frameTime/fadeTime;
+
+                        if (fade <= 0.0f) {
+                            fade = 0.0f;
+                            accumulator = 0.0f;
+                            phase = PLAYING;
+                        }
+
+                        break;
+                    }
+
+                    case PLAYING: {
+                        MiniGame* game = games[active].get();
+                        accumulator += frameTime;
+
+                        while (accumulator >= timeStep) {
+                            TRACE_SCOPE("physics step", "physics");
+
+                            game->step(timeStep);
+                            accumulator -= timeStep;
+                        }
+
+                        game->update();
+
+                        if (game->finished() && games.size() > 1) { switchTo((active + 1) % games.size()); }
+                        break;
+                    }
+                }
+            };
+
+            // * Draw the active game with the fade overlay, or the loading screen.
+            void draw() const {
+                if (phase == IDLE) { return; }
+
+                if (phase == LOADING) {
+                    const char* name = games[active]->name();
+                    int textWidth = MeasureText(name, 50);
+
+                    DrawText(name, (GetScreenWidth() - textWidth)/2, GetScreenHeight()/2 - 50, 50, WHITE);
+                    DrawText("Loading...", (GetScreenWidth() - MeasureText("Loading...", 30))/2, GetScreenHeight()/2 + 10, 30, GRAY);
+                    return;
+                }
+
+                games[active]->draw();
+
+                if (fade > 0.0f) {
+                    DrawRectangle(0, 0, GetScreenWidth(), GetScreenHeight(), {0, 0, 0, (unsigned char) (255.0f*(fade < 1.0f ? fade : 1.0f))});
+                }
+            };
+    };
+}
+
+#endif // !SCENE_H
@@ -0,0 +1,108 @@
+#ifndef SDF_H
+#define SDF_H
+
+#include <vector>
+#include "physics.h"
+
+// * =====================================
+// * Signed Distance Field
+// * =====================================
+
+// ? Distance to the nearest wall, sampled on a regular grid finer than the tiles and stored at load time. Samples are
+// ?  negative inside walls. Reading the field anywhere takes the four samples around the point, blended bilinearly, and
+// ?  its gradient points away from the nearest wall, so one read gives both how far a circle is from the walls and which
+// ?  way to push it out. This costs the same however many walls there are, and walls of any shape can be baked in.
+// ? Distances are clamped to a range, as only walls near a ball matter, which keeps the bake cheap.
+
+namespace Physics {
+    /**
+     * @brief Signed distance from a point to a rotated box. Negative inside the box.
+     *
+     * @param p The point.
+     * @param b The box.
+     * @return The distance.
+     */
+    float SignedDistance(ZMath::Vec2D const &p, Box2D const &b) {
+        ZMath::Vec2D local = b.rot.transpose() * (p - b.pos);
+        ZMath::Vec2D q(ZMath::abs(local.x) - b.getHalfsize().x, ZMath::abs(local.y) - b.getHalfsize().y);
+
+        float outside = ZMath::Vec2D(ZMath::max(q.x, 0.0f), ZMath::max(q.y, 0.0f)).mag();
+        return outside + ZMath::min(ZMath::max(q.x, q.y), 0.0f);
+    };
+
+    class SignedDistanceField {
+        private:
+            std::vector<float> samples; // row major.
+            ZMath::Vec2D origin; // position of the first sample.
+            float spacing = 4.0f; // distance between neighbouring samples.
+            float invSpacing = 0.25f;
+            int cols = 0, rows = 0;
+
+        public:
+            SignedDistanceField() = default;
+
+            /**
+             * @brief Sample a distance function over a rectangle.
+             *
+             * @param min Top left corner of the rectangle.
+             * @param max Bottom right corner of the rectangle.
+             * @param spacing Distance between samples.
+             * @param range Distances are clamped to [-range, range].
+             * @param dist dist(p) gives the signed distance from p to the walls.
+             */
+            template <typename Dist>
+            void build(ZMath::Vec2D const &min, ZMath::Vec2D const &max, float spacing, float range, Dist const &dist) {
+                origin = min;
+                this->spacing = spacing;
+                invSpacing = 1.0f/spacing;
+                cols = (int) ceilf((max.x - min.x)*invSpacing) + 1;
+                rows = (int) ceilf((max.y - min.y)*invSpacing) + 1;
+
+                samples.resize(cols*rows);
+
+                for (int y = 0; y < rows; ++y) {
+                    for (int x = 0; x < cols; ++x) {
+                        samples[y*cols + x] = ZMath::clamp(dist(origin + ZMath::Vec2D(x*spacing, y*spacing)), -range, range);
+                    }
+                }
+            };
+
+            // * Remove every sample.
+            void clear() {
+                samples.clear();
+                cols = rows = 0;
+            };
+
+            /**
+             * @brief Read the field at a point. Points outside the field read its nearest edge.
+             *
+             * @param p The point.
+             * @param gradient Set to the gradient of the field at the point, pointing away from the nearest wall. It is not normalized.
+             * @return The signed distance to the nearest wall.
+             */
+            float sample(ZMath::Vec2D const &p, ZMath::Vec2D &gradient) const {
+                ZMath::Vec2D g = ZMath::clamp((p - origin)*invSpacing, ZMath::Vec2D(), ZMath::Vec2D(cols - 1.001f, rows - 1.001f));
+                int x = (int) g.x, y = (int) g.y;
+                float fx = g.x - x, fy = g.y - y;
+
+                float const* row = samples.data() + y*cols + x;
+                float d00 = row[0], d10 = row[1], d01 = row[cols], d11 = row[cols + 1];
+
+                gradient = ZMath::Vec2D(((d10 - d00)*(1.0f - fy) + (d11 - d01)*fy)*invSpacing,
+                                        ((d01 - d00)*(1.0f - fx) + (d11 - d10)*fx)*invSpacing);
+
+                return (d00*(1.0f - fx) + d10*fx)*(1.0f - fy) + (d01*(1.0f - fx) + d11*fx)*fy;
+            };
+
+            // * Read the field at a point.
+            inline float sample(ZMath::Vec2D const &p) const {
+                ZMath::Vec2D gradient;
+                return sample(p, gradient);
+            };
+
+            // * Bytes of memory used.
+            inline size_t bytes() const { return samples.capacity()*sizeof(float); };
+    };
+}
+
+#endif // !SDF_H
@@ -0,0 +1,222 @@
+#ifndef SIMCACHE_H
+#define SIMCACHE_H
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <vector>
+#include "rng.h"
+#include "trickshot.h"
+
+// * =====================================
+// * Memoised Shot Simulation Cache
+// * =====================================
+
+// ? Caches where a shot ends, keyed by the map checksum and the quantised start position and shot vector.
+// ? Shots are always simulated from their quantised inputs, so a result is the same whether it came from the cache
+// ?  or from a fresh simulation, and a cache file written by one run is valid for any later run on the same map.
+// ? Memory is bounded: the table is allocated once and split into sets of WAYS entries. A full set replaces its least
+// ?  recently used entry. Sets are guarded by a fixed number of striped locks so many threads can use the cache at once.
+
+namespace SimCache {
+    // * Where a simulated shot ended.
+    struct ShotResult {
+        ZMath::Vec2D rest; // position the ball stopped at (the stage's starting position if it landed in water).
+        TrickShot::StepResult outcome; // STOPPED, WATER, SUNK, or MOVING if it ran out of steps.
+    };
+
+    struct Config {
+        float posQuantum = 0.125f; // start positions are rounded to multiples of this (pixels).
+        float shotQuantum = 0.25f; // shot vectors are rounded to multiples of this (pixels dragged).
+        float timeStep = 0.0167f; // physics step used for every simulation.
+        uint maxSteps = 3600; // steps before a moving ball is left where it is.
+    };
+
+    class Cache {
+        private:
+            struct Key {
+                uint64_t map;
+                int32_t x, y, vx, vy;
+
+                bool operator == (Key const &k) const { return map == k.map && x == k.x && y == k.y && vx == k.vx && vy == k.vy; };
+            };
+
+            struct Entry {
+                Key key;
+                float restX, restY;
+                uint32_t outcome;
+                uint32_t lastUse; // 0 marks an empty entry.
+            };
+
+            static const uint WAYS = 4;
+            static const uint LOCKS = 256;
+            static constexpr uint32_t FILE_MAGIC = 0x43535354; // "TSSC"
+            static constexpr uint32_t FILE_VERSION = 1;
+
+            Config config;
+            std::vector<Entry> entries;
+            size_t numSets;
+            std::mutex locks[LOCKS];
+
+            std::atomic<uint32_t> clock{1};
+            std::atomic<uint64_t> hitCount{0}, missCount{0};
+
+            inline int32_t quantise(float v, float q) const { return (int32_t) std::lround(v / q); };
+
+            inline uint64_t hash(Key const &k) const {
+                uint64_t h = Random::mix64(k.map ^ ((uint64_t) (uint32_t) k.x << 32 | (uint32_t) k.y));
+                return Random::mix64(h ^ ((uint64_t) (uint32_t) k.vx << 32 | (uint32_t) k.vy));
+            };
+
+            // Find a key. Returns 1 and fills res on a hit.
+            bool find(Key const &key, ShotResult &res) {
+                size_t set = hash(key) % numSets;
+                std::lock_guard<std::mutex> lock(locks[set % LOCKS]);
+
+                Entry* e = &entries[set*WAYS];
+                for (uint w = 0; w < WAYS; ++w) {
+                    if (e[w].lastUse && e[w].key == key) {
+                        e[w].lastUse = clock++;
+                        res = {ZMath::Vec2D(e[w].restX, e[w].restY), (TrickShot::StepResult) e[w].outcome};
+                        return 1;
+                    }
+                }
+
+                return 0;
+            };
+
+            // Insert a key, replacing the least recently used entry of its set if the set is full.
+            void insert(Key const &key, ShotResult const &res) {
+                size_t set = hash(key) % numSets;
+                std::lock_guard<std::mutex> lock(locks[set % LOCKS]);
+
+                Entry* e = &entries[set*WAYS];
+                Entry* victim = e;
+
+                for (uint w = 0; w < WAYS; ++w) {
+                    if (!e[w].lastUse || e[w].key == key) { victim = &e[w]; break; }
+                    if (e[w].lastUse < victim->lastUse) { victim = &e[w]; }
+                }
+
+                *victim = {key, res.rest.x, res.rest.y, (uint32_t) res.outcome, clock++};
+            };
+
+        public:
+            /**
+             * @brief Create a cache.
+             *
+             * @param bytes Memory to use for entries. Allocated up front and never exceeded.
+             * @param config Quantisation and simulation settings. Cache files only load into a cache with the same settings.
+             */
+            Cache(size_t bytes = 128u << 20, Config const &config = Config()) : config(config) {
+                numSets = bytes / (WAYS*sizeof(Entry));
+                if (!numSets) { numSets = 1; }
+                entries.resize(numSets*WAYS, Entry{});
+            };
+
+            Cache(Cache const &) = delete;
+            Cache& operator = (Cache const &) = delete;
+
+            inline Config const& getConfig() const { return config; };
+
+            /**
+             * @brief Simulate a shot, or return the cached result of an earlier one with the same quantised inputs.
+             *        Safe to call from several threads at once.
+             *
+             * @param stage The stage to shoot on. Only its checksum and physics are used.
+             * @param start Position of the ball before the shot.
+             * @param shot Shot vector, the same as passed to Stage::shoot.
+             * @return Where the shot ended.
+             */
+            ShotResult simulate(TrickShot::Stage const &stage, ZMath::Vec2D const &start, ZMath::Vec2D const &shot) {
+                Key key = {stage.getChecksum(), quantise(start.x, config.posQuantum), quantise(start.y, config.posQuantum),
+                           quantise(shot.x, config.shotQuantum), quantise(shot.y, config.shotQuantum)};
+
+                ShotResult res;
+                if (find(key, res)) {
+                    hitCount++;
+                    return res;
+                }
+
+                missCount++;
+
+                TrickShot::Ball ball = stage.getBall();
+                ball.hitbox.c = ZMath::Vec2D(key.x * config.posQuantum, key.y * config.posQuantum);
+                ball.prevPos = ball.hitbox.c;
+                ball.vel = ZMath::Vec2D(key.vx * config.shotQuantum, key.vy * config.shotQuantum);
+                ball.canHit = 1;
+
+                res.outcome = stage.simulate(ball, config.timeStep, config.maxSteps);
+                res.rest = ball.hitbox.c;
+
+                insert(key, res);
+                return res;
+            };
+
+            inline uint64_t hits() const { return hitCount; };
+            inline uint64_t misses() const { return missCount; };
+
+            // * Number of entries in use.
+            size_t size() const {
+                size_t n = 0;
+                for (Entry const &e : entries) { n += e.lastUse != 0; }
+                return n;
+            };
+
+            // * Number of entries the cache can hold.
+            inline size_t capacity() const { return entries.size(); };
+
+            /**
+             * @brief Write every entry to a file. Call when no other thread is using the cache.
+             *
+             * @return Was the file written.
+             */
+            bool save(const char* path) const {
+                FILE* f = fopen(path, "wb");
+                if (!f) { return 0; }
+
+                uint64_t count = size();
+                bool ok = fwrite(&FILE_MAGIC, sizeof(FILE_MAGIC), 1, f) && fwrite(&FILE_VERSION, sizeof(FILE_VERSION), 1, f) &&
+                          fwrite(&config, sizeof(config), 1, f) && fwrite(&count, sizeof(count), 1, f);
+
+                for (size_t i = 0; ok && i < entries.size(); ++i) {
+                    if (entries[i].lastUse) { ok = fwrite(&entries[i], sizeof(Entry), 1, f); }
+                }
+
+                return !fclose(f) && ok;
+            };
+
+            /**
+             * @brief Add the entries from a file written by save(). Entries beyond the capacity replace older ones as usual.
+             *        Call when no other thread is using the cache.
+             *
+             * @return 0 if the file is missing, unreadable, or was written with different settings.
+             */
+            bool load(const char* path) {
+                FILE* f = fopen(path, "rb");
+                if (!f) { return 0; }
+
+                uint32_t magic = 0, version = 0;
+                Config fileConfig;
+                uint64_t count = 0;
+
+                bool ok = fread(&magic, sizeof(magic), 1, f) && fread(&version, sizeof(version), 1, f) &&
+                          fread(&fileConfig, sizeof(fileConfig), 1, f) && fread(&count, sizeof(count), 1, f) &&
+                          magic == FILE_MAGIC && version == FILE_VERSION && !memcmp(&fileConfig, &config, sizeof(config));
+
+                Entry e;
+                for (uint64_t i = 0; ok && i < count; ++i) {
+                    ok = fread(&e, sizeof(Entry), 1, f);
+                    if (ok) { insert(e.key, {ZMath::Vec2D(e.restX, e.restY), (TrickShot::StepResult) e.outcome}); }
+                }
+
+                fclose(f);
+                return ok;
+            };
+    };
+}
+
+#endif // !SIMCACHE_H
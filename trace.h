@@ -0,0 +1,199 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// * ======================================
+// * Chrome trace_event Export
+// * ======================================
+
+// ? Spans are recorded into an in-memory buffer and handed off to a background thread that writes them out
+// ?  in the Chrome trace_event JSON format. Open the resulting file in Perfetto (ui.perfetto.dev) or chrome://tracing.
+// ? Tracing is off unless Trace::start is called, in which case a Scope costs a single branch.
+
+namespace Trace {
+    // A single complete ("X") event.
+    // Names and categories must be string literals (or otherwise outlive the trace) as only the pointer is stored.
+    struct Event {
+        const char* name;
+        const char* cat;
+        uint64_t ts; // start time in microseconds since the trace started
+        uint64_t dur; // duration in microseconds
+        uint32_t tid; // id of the thread that recorded the event
+    };
+
+    class Tracer {
+        private:
+            // Number of events buffered before they are handed to the writer thread.
+            static const size_t FLUSH_THRESHOLD = 4096;
+
+            std::vector<Event> front; // events currently being recorded
+            std::vector<Event> back; // events being written out
+            std::mutex bufMutex;
+            std::condition_variable cv;
+            std::thread writer;
+
+            FILE* out = nullptr;
+            bool firstEvent = 1;
+            bool pending = 0; // back holds events that need to be written
+            bool stopping = 0;
+
+            std::chrono::steady_clock::time_point epoch;
+
+            // Write every event in back to the output file.
+            void writeBack() {
+                for (const Event &e : back) {
+                    fprintf(out, "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,\"pid\":1,\"tid\":%u}",
+                            firstEvent ? "" : ",", e.name, e.cat, (unsigned long long) e.ts, (unsigned long long) e.dur, e.tid);
+                    firstEvent = 0;
+                }
+
+                back.clear();
+            };
+
+            void writerLoop() {
+                std::unique_lock<std::mutex> lock(bufMutex);
+
+                while (1) {
+                    cv.wait(lock, [this] { return pending || stopping; });
+
+                    if (pending) {
+                        // back is only touched by this thread while pending is set, so the lock can be released while writing.
+                        lock.unlock();
+                        writeBack();
+                        lock.lock();
+
+                        pending = 0;
+                        cv.notify_all();
+                    }
+
+                    if (stopping && !pending) { return; }
+                }
+            };
+
+        public:
+            std::atomic<bool> enabled{0};
+
+            Tracer() = default;
+
+            /**
+             * @brief Start recording events to a file.
+             *
+             * @param path Path of the JSON file to write.
+             * @return 1 if the file could be opened, 0 otherwise.
+             */
+            bool start(const char* path) {
+                out = fopen(path, "w");
+                if (!out) { return 0; }
+
+                fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", out);
+
+                front.reserve(FLUSH_THRESHOLD);
+                back.reserve(FLUSH_THRESHOLD);
+                epoch = std::chrono::steady_clock::now();
+
+                writer = std::thread(&Tracer::writerLoop, this);
+                enabled = 1;
+                return 1;
+            };
+
+            // Stop recording, write out any remaining events, and close the file.
+            void stop() {
+                if (!enabled) { return; }
+                enabled = 0;
+
+                {
+                    std::unique_lock<std::mutex> lock(bufMutex);
+                    cv.wait(lock, [this] { return !pending; });
+
+                    front.swap(back);
+                    pending = !back.empty();
+                    stopping = 1;
+                }
+
+                cv.notify_all();
+                writer.join();
+
+                fputs("\n]}\n", out);
+                fclose(out);
+                out = nullptr;
+            };
+
+            // Current time in microseconds since the trace started.
+            inline uint64_t now() const {
+                return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - epoch).count();
+            };
+
+            // Record a completed span.
+            void record(const char* name, const char* cat, uint64_t ts, uint64_t dur) {
+                static std::atomic<uint32_t> nextTid{1};
+                thread_local uint32_t tid = nextTid++;
+
+                std::unique_lock<std::mutex> lock(bufMutex);
+                front.push_back({name, cat, ts, dur, tid});
+
+                if (front.size() >= FLUSH_THRESHOLD) {
+                    // The writer should be long done with the last batch; only block if it has fallen behind.
+                    cv.wait(lock, [this] { return !pending; });
+
+                    front.swap(back);
+                    pending = 1;
+                    lock.unlock();
+                    cv.notify_all();
+                }
+            };
+
+            ~Tracer() { stop(); };
+    };
+
+    // The tracer shared by the whole program.
+    inline Tracer& tracer() {
+        static Tracer t;
+        return t;
+    };
+
+    // * Start tracing to the given file. Returns 0 if the file could not be opened.
+    inline bool start(const char* path) { return tracer().start(path); };
+
+    // * Stop tracing and finish writing the file.
+    inline void stop() { tracer().stop(); };
+
+    // * RAII span covering the lifetime of the object.
+    class Scope {
+        private:
+            const char* name;
+            const char* cat;
+            uint64_t ts;
+            bool active;
+
+        public:
+            Scope(const char* name, const char* cat = "game") : name(name), cat(cat), active(tracer().enabled) {
+                if (active) { ts = tracer().now(); }
+            };
+
+            Scope(Scope const &scope) = delete;
+            Scope& operator = (Scope const &scope) = delete;
+
+            ~Scope() {
+                if (active) {
+                    uint64_t end = tracer().now();
+                    tracer().record(name, cat, ts, end - ts);
+                }
+            };
+    };
+}
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+// * Trace the rest of the enclosing block as a span with the given name (and optionally category).
+#define TRACE_SCOPE(...) Trace::Scope TRACE_CONCAT(traceScope_, __LINE__)(__VA_ARGS__)
+
+#endif // !TRACE_H
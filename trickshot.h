@@ -1,10 +1,20 @@
 #ifndef TRICKSHOT_H
 #define TRICKSHOT_H
 
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
 #include <fstream>
-#include <sstream>
+#include <vector>
 #include "raylib.h"
+#include "aabbtree.h"
+#include "boundary.h"
+#include "broadphase.h"
 #include "physics.h"
+#include "replay.h"
+#include "sdf.h"
+#include "trace.h"
 
 typedef unsigned int uint;
 
@@ -15,12 +25,128 @@ typedef unsigned int uint;
 // * =======================
 
 namespace TrickShot {
+    // * Bytes attributed to each part of a stage.
+    struct MemoryUsage {
+        size_t grid = 0; // tile grid storage.
+        size_t colliders = 0; // collider arrays.
+        size_t images = 0; // decoded images. These are freed once uploaded, so this is the peak during init and not resident.
+        size_t textures = 0; // estimated VRAM used by the stage's textures.
+        size_t overhead = 0; // the Stage object itself.
+
+        // Resident bytes (decoded images are not included as they are freed after upload).
+        inline size_t resident() const { return grid + colliders + textures + overhead; };
+
+        MemoryUsage& operator += (MemoryUsage const &mem) {
+            grid += mem.grid;
+            colliders += mem.colliders;
+            images += mem.images;
+            textures += mem.textures;
+            overhead += mem.overhead;
+
+            return (*this);
+        };
+    };
+
+    // Estimate the VRAM used by a texture, including its mipmaps.
+    inline size_t textureBytes(Texture2D const &text) {
+        if (!text.id) { return 0; }
+
+        size_t bytes = 0;
+        int w = text.width, h = text.height;
+
+        for (int i = 0; i < text.mipmaps; ++i) {
+            bytes += GetPixelDataSize(w, h, text.format);
+            w = w > 1 ? w/2 : 1;
+            h = h > 1 ? h/2 : 1;
+        }
+
+        return bytes;
+    };
+
     struct Ball {
         Color color; // color of the golf ball.
         Physics::Circle hitbox; // Circle representing the ball.
         ZMath::Vec2D vel; // ball's velocity in terms of pixels.
         ZMath::Vec2D prevPos; // ball's previous position.
         float linearDamping = 0.98f; // friction applied to the ball.
+        bool canHit = 0; // used to determine if the ball can hit the hole
+    };
+
+    // * Outcome of a single physics step.
+    enum StepResult {
+        MOVING, // the ball is still moving.
+        STOPPED, // the ball came to rest.
+        WATER, // the ball fell in the water and was returned to the start.
+        SUNK // the ball went in the hole.
+    };
+
+    // * What a tile does to a ball rolling over it.
+    struct Material {
+        float friction = 1.0f; // fraction of the velocity kept each step.
+        float boost = 1.0f; // factor the velocity is multiplied by each step, while under MAX_BOOST_SPEED.
+        bool hazard = 0; // sends the ball back to the start.
+    };
+
+    static constexpr float MAX_BOOST_SPEED = 1000.0f;
+
+    // * Material of each tile character. New materials only need an entry here and a texture in Stage::draw().
+    inline constexpr std::array<Material, 256> MATERIALS = [] {
+        std::array<Material, 256> m;
+        m.fill(Material());
+        m['B'].boost = 1.1f; // boost panel
+        m['s'].friction = 0.965f; // sand
+        m['W'].hazard = 1; // water
+        return m;
+    }();
+
+    // * A previous run being replayed alongside live play.
+    struct Ghost {
+        Ball ball;
+        Replay::Run run; // copy of the run, so the best runs can change while it plays.
+        Replay::Reader reader;
+        uint32_t shotStep = 0; // step of the next shot.
+        int32_t shotX = 0, shotY = 0; // drag of the next shot.
+        bool hasShot = 0; // is there a next shot.
+        bool sunk = 0;
+    };
+
+    // * How a kinematic obstacle moves.
+    enum Motion {
+        FIXED, // does not move, like a wall at an angle.
+        SPIN, // rotates about its center at a constant speed, like a windmill bar.
+        SLIDE // slides to an offset and back, easing in and out at the ends, like a gate.
+    };
+
+    // * A rotated box that stays still or moves along a fixed curve of time. Balls bounce off it but do not push it.
+    struct Obstacle {
+        Motion motion = FIXED;
+        Physics::Box2D rest; // pose at time 0.
+        float speed = 0.0f; // SPIN: degrees per second, clockwise on screen.
+        ZMath::Vec2D travel; // SLIDE: offset from the rest pose at the far end.
+        float period = 1.0f; // SLIDE: seconds to go to the far end and back.
+
+        // Pose t seconds after the run started.
+        Physics::Box2D poseAt(float t) const {
+            Physics::Box2D box = rest;
+
+            if (motion == SPIN) {
+                box.theta = fmodf(rest.theta + speed*t, 360.0f);
+                box.rot = ZMath::Mat2D::rotationMat(box.theta);
+
+            } else if (motion == SLIDE) {
+                box.pos = rest.pos + travel*(0.5f - 0.5f*ZMath::cosDeg(360.0f*fmodf(t/period, 1.0f)));
+            }
+
+            return box;
+        };
+
+        // Bounds used in the obstacle tree. A spinning bar gets the box around its whole sweep so it never needs reinserting.
+        Physics::AABB bounds(Physics::Box2D const &box) const {
+            if (motion != SPIN) { return box.getBounds(); }
+
+            float r = box.getHalfsize().mag();
+            return Physics::AABB(box.pos - ZMath::Vec2D(r, r), box.pos + ZMath::Vec2D(r, r));
+        };
     };
 
     class Stage {
@@ -40,37 +166,471 @@ namespace TrickShot {
             bool complete = 0; // has the stage been completed
 
         private:
-            char** grid; // grid for drawing the sprites
-
-            Ball ball; // The ball the player shoots.
+            char** grid = nullptr; // grid for drawing the sprites
+
+            // players, taking turns to shoot their own ball
+            static const uint MAX_BALLS = 8;
+            static constexpr Color PLAYER_COLORS[MAX_BALLS] = {WHITE, RED, BLUE, YELLOW, ORANGE, PURPLE, PINK, SKYBLUE};
+            Ball balls[MAX_BALLS]; // ball of each player.
+            uint numBalls = 1; // number of players.
+            uint turn = 0; // player whose turn it is.
+            bool sunk[MAX_BALLS] = {}; // has the player's ball gone in the hole.
+            bool onCourse[MAX_BALLS] = {}; // has the player teed off. Balls still waiting at the tee are not drawn or collided.
+            bool shotPending = 0; // a shot was taken and the turn passes on once every ball stops.
+
+            // ball-ball collisions
+            static constexpr float BALL_RESTITUTION = 0.9f; // fraction of the closing speed kept when two balls collide.
+            Physics::SweepAndPrune broadphase;
+            Physics::Circle hitboxes[MAX_BALLS]; // hitboxes of the balls at the start of the collision pass.
+            bool inPlay[MAX_BALLS] = {}; // balls taking part in the collision pass.
             Physics::Circle hole; // Circle representing the hole. This should lay in one tile.
 
             // textures
-            Texture2D wallText;
-            Texture2D panelText;
-            Texture2D sandText;
-            Texture2D waterText;
+            Texture2D wallText = {0};
+            Texture2D panelText = {0};
+            Texture2D sandText = {0};
+            Texture2D waterText = {0};
+            Image images[4] = {}; // images decoded by prepare() waiting to be uploaded by upload().
+            size_t imageBytes = 0; // bytes of decoded image data at the last init.
 
             // colliders
-            Physics::AABB* tiles; // special tiles.
+            Physics::AABB* tiles = nullptr; // special tiles.
             uint numWalls = 0; // number of walls.
             uint numPanels = 0; // number of boost panels.
             uint numSand = 0; // number of sand tiles.
             uint numWater = 0; // number of water tiles.
+            Physics::SignedDistanceField walls; // distance to the walls, which is what the ball collides with.
+            bool* wallTiles = nullptr; // which tiles the axis aligned walls cover, row major. Rays are cast against these.
 
             // offsets
             uint panelOffset;
             uint sandOffset;
             uint waterOffset;
 
+            // kinematic obstacles
+            Obstacle* obstacles = nullptr;
+            uint numObstacles = 0;
+            Physics::Box2D* obstacleBoxes = nullptr; // poses at the current step, then the previous step's, then the rest poses.
+            Physics::Box2D* prevObstacleBoxes = nullptr;
+            Physics::Box2D* restObstacleBoxes = nullptr;
+            int32_t* obstacleLeaves = nullptr; // leaf of each obstacle in obstacleTree.
+            Physics::AABBTree obstacleTree{16.0f}; // bounds of the obstacles at the current step, fattened by a tile. Main thread only.
+            Physics::AABBTree restTree; // bounds at the rest poses. Never changes after loading, so any thread can read it.
+
             ZMath::Vec2D startingPos; // starting position of the ball
             ZMath::Vec2D offset; // offset to center the stage in the screen
 
-            uint strokes = 1; // number of strokes the player has taken
-            bool canHit = 0; // used to determine if the ball can hit the hole
+            uint strokes[MAX_BALLS]; // number of strokes each player has taken, plus one.
+
+            uint64_t checksum = 0; // hash of everything in the map that affects the physics.
+
+            // Hashed into the checksum. Bump it when a change to step() changes how shots play, so cached results go stale.
+            static constexpr uint32_t PHYSICS_VERSION = 7;
+
+            // replays
+            static const uint MAX_GHOSTS = 3;
+            uint32_t stepCount = 0; // physics steps since the run started.
+            Replay::Run run; // shots of the run being played.
+            Replay::Run bestRuns[MAX_GHOSTS]; // best complete runs, best first.
+            uint numBestRuns = 0;
+            Ghost ghosts[MAX_GHOSTS]; // replays of the best runs as they were when the current run started.
+            uint numGhosts = 0;
+
+            // HUD text, formatted only when strokes, turn, or complete change so drawing does not allocate.
+            char hudText[48];
+
+            // Format the stroke counter or completion message into hudText.
+            void formatHUD() {
+                if (numBalls == 1) {
+                    if (!complete) { snprintf(hudText, sizeof(hudText), "Stroke: %u", strokes[0]); }
+                    else if (strokes[0] == 2) { snprintf(hudText, sizeof(hudText), "Hole in One!"); }
+                    else { snprintf(hudText, sizeof(hudText), "You made it in %u strokes!", strokes[0] - 1); }
+                    return;
+                }
+
+                if (!complete) {
+                    snprintf(hudText, sizeof(hudText), "Player %u - Stroke: %u", turn + 1, strokes[turn]);
+                    return;
+                }
+
+                uint best = 0, numBest = 0;
+                for (uint i = 0; i < numBalls; ++i) {
+                    if (strokes[i] < strokes[best]) { best = i; numBest = 0; }
+                    if (strokes[i] == strokes[best]) { numBest++; }
+                }
+
+                if (numBest > 1) { snprintf(hudText, sizeof(hudText), "Tied in %u strokes!", strokes[best] - 1); }
+                else { snprintf(hudText, sizeof(hudText), "Player %u wins in %u strokes!", best + 1, strokes[best] - 1); }
+            };
+
+            // Put every ball back on the tee with no strokes taken, first player to shoot.
+            void placeBalls() {
+                for (uint i = 0; i < MAX_BALLS; ++i) {
+                    balls[i] = {PLAYER_COLORS[i], Physics::Circle(startingPos, 8.0f), ZMath::Vec2D(), startingPos};
+                    strokes[i] = 1;
+                    sunk[i] = 0;
+                    onCourse[i] = 0;
+                }
+
+                onCourse[0] = 1;
+                turn = 0;
+                shotPending = 0;
+                complete = 0;
+            };
+
+            // Separate two overlapping balls and, if they are moving together, bounce them off each other.
+            // The balls have equal mass, so the impulse is shared equally.
+            void collideBalls(uint a, uint b) {
+                Ball &A = balls[a], &B = balls[b];
+
+                ZMath::Vec2D d = B.hitbox.c - A.hitbox.c;
+                float r = A.hitbox.r + B.hitbox.r, distSq = d.magSq();
+                if (distSq >= r*r) { return; }
+
+                float dist = ZMath::sqrt(distSq);
+                ZMath::Vec2D n = dist > 0.0f ? d * (1.0f/dist) : ZMath::Vec2D(1.0f, 0.0f);
+
+                ZMath::Vec2D push = n * (0.5f*(r - dist));
+                A.hitbox.c -= push;
+                B.hitbox.c += push;
+
+                float vn = (B.vel - A.vel) * n;
+                if (vn >= 0.0f) { return; }
+
+                ZMath::Vec2D impulse = n * (-0.5f*(1.0f + BALL_RESTITUTION)*vn);
+                A.vel -= impulse;
+                B.vel += impulse;
+
+                // a ball knocked by another can still drop in the hole
+                A.canHit = 1;
+                B.canHit = 1;
+            };
+
+            // Resolve the contacts between the balls in play.
+            void collideBalls() {
+                if (numBalls < 2) { return; }
+
+                for (uint i = 0; i < numBalls; ++i) {
+                    hitboxes[i] = balls[i].hitbox;
+                    inPlay[i] = onCourse[i] && !sunk[i];
+                }
+
+                broadphase.findPairs(hitboxes, inPlay, numBalls, [this](uint32_t a, uint32_t b) { collideBalls(a, b); });
+            };
+
+            // FNV-1a hash of the grid, colliders, ball start, and hole.
+            uint64_t computeChecksum() const {
+                uint64_t h = 0xcbf29ce484222325ull;
+
+                auto add = [&h](void const* data, size_t size) {
+                    for (size_t i = 0; i < size; ++i) { h = (h ^ ((unsigned char const*) data)[i]) * 0x100000001b3ull; }
+                };
+
+                add(&PHYSICS_VERSION, sizeof(PHYSICS_VERSION));
+                add(&width, sizeof(width));
+                add(&height, sizeof(height));
+                for (uint i = 0; i < height; ++i) { add(grid[i], width); }
+
+                uint counts[4] = {numWalls, numPanels, numSand, numWater};
+                add(counts, sizeof(counts));
+
+                for (uint i = 0; i < waterOffset; ++i) {
+                    ZMath::Vec2D bounds[2] = {tiles[i].getMin(), tiles[i].getMax()};
+                    add(bounds, sizeof(bounds));
+                }
+
+                for (uint i = 0; i < numObstacles; ++i) {
+                    Obstacle const &o = obstacles[i];
+                    float params[9] = {(float) o.motion, o.rest.pos.x, o.rest.pos.y, o.rest.getHalfsize().x, o.rest.getHalfsize().y,
+                                       o.rest.theta, o.speed, o.travel.x, o.travel.y};
+                    add(params, sizeof(params));
+                    add(&o.period, sizeof(o.period));
+                }
+
+                add(&startingPos, sizeof(startingPos));
+                add(&hole, sizeof(hole));
+
+                return h;
+            };
+
+            // Free the grid and colliders so another map can be loaded.
+            void unloadMap() {
+                if (grid) {
+                    for (uint i = 0; i < height; ++i) { delete[] grid[i]; }
+                    delete[] grid;
+                    grid = nullptr;
+                }
+
+                delete[] tiles;
+                tiles = nullptr;
+
+                delete[] obstacles;
+                delete[] obstacleBoxes;
+                delete[] obstacleLeaves;
+                obstacles = nullptr;
+                obstacleBoxes = prevObstacleBoxes = restObstacleBoxes = nullptr;
+                obstacleLeaves = nullptr;
+                numObstacles = 0;
+
+                obstacleTree.clear();
+                restTree.clear();
+                walls.clear();
+
+                delete[] wallTiles;
+                wallTiles = nullptr;
+            };
+
+            // Move the obstacles to their poses t seconds into the run, refitting the tree where they left their fat bounds.
+            void moveObstacles(float t) {
+                for (uint i = 0; i < numObstacles; ++i) {
+                    if (obstacles[i].motion == FIXED) { continue; }
+
+                    prevObstacleBoxes[i] = obstacleBoxes[i];
+                    obstacleBoxes[i] = obstacles[i].poseAt(t);
+                    obstacleTree.move(obstacleLeaves[i], obstacles[i].bounds(obstacleBoxes[i]), obstacleBoxes[i].pos - prevObstacleBoxes[i].pos);
+                }
+            };
+
+            // Put the obstacles back at their rest poses.
+            void restObstacles() {
+                for (uint i = 0; i < numObstacles; ++i) {
+                    if (obstacles[i].motion == FIXED) { continue; }
+
+                    obstacleBoxes[i] = prevObstacleBoxes[i] = restObstacleBoxes[i];
+                    obstacleTree.move(obstacleLeaves[i], obstacles[i].bounds(obstacleBoxes[i]), ZMath::Vec2D());
+                }
+            };
+
+            // Bake the distance field of the walls: the outline of the tiles the axis aligned walls cover, and the walls at an angle.
+            void buildWalls() {
+                wallTiles = new bool[width*height]();
+
+                for (uint i = 0; i < numWalls; ++i) {
+                    ZMath::Vec2D min = (tiles[i].getMin() - offset)*(1.0f/16), max = (tiles[i].getMax() - offset)*(1.0f/16);
+
+                    for (uint y = (uint) roundf(min.y); y < (uint) roundf(max.y) && y < height; ++y) {
+                        for (uint x = (uint) roundf(min.x); x < (uint) roundf(max.x) && x < width; ++x) { wallTiles[y*width + x] = 1; }
+                    }
+                }
+
+                // the outline's edges only lie between wall and open tiles, so seams between walls don't show up in the field
+                Physics::Boundary boundary;
+                boundary.build(width, height, 16.0f, offset, [&](uint row, uint col) { return wallTiles[row*width + col]; });
+
+                ZMath::Vec2D range(WALL_FIELD_RANGE, WALL_FIELD_RANGE);
+
+                walls.build(offset, offset + ZMath::Vec2D(width*16.0f, height*16.0f), WALL_FIELD_SPACING, WALL_FIELD_RANGE, [&](ZMath::Vec2D const &p) {
+                    float d = WALL_FIELD_RANGE;
+                    boundary.query(Physics::AABB(p - range, p + range), [&](uint32_t item) {
+                        d = ZMath::min(d, Physics::Distance(p, boundary.edge(item)));
+                    });
+
+                    // samples on a tile's side are on an edge or between two walls, so either tile gives the right sign
+                    ZMath::Vec2D tile = (p - offset)*(1.0f/16);
+                    uint col = ZMath::min(tile.x, width - 1.0f), row = ZMath::min(tile.y, height - 1.0f);
+                    if (wallTiles[row*width + col]) { d = -d; }
+
+                    for (uint i = 0; i < numObstacles && obstacles[i].motion == FIXED; ++i) { d = ZMath::min(d, Physics::SignedDistance(p, obstacles[i].rest)); }
+
+                    return d;
+                });
+            };
+
+            /**
+             * @brief Read the optional obstacle section after the colliders: a count, then one obstacle per line (see map.info).
+             * 
+             * @param f Stream positioned after the colliders.
+             * @param angledWalls Walls at an angle from the collider list. They are kept as fixed obstacles before the moving ones.
+             */
+            void loadObstacles(std::istream &f, std::vector<Physics::Box2D> const &angledWalls) {
+                std::string line;
+                uint numMoving = getline(f, line) && !line.empty() ? std::stoi(line) : 0;
+
+                numObstacles = angledWalls.size() + numMoving;
+                if (!numObstacles) { return; }
+
+                obstacles = new Obstacle[numObstacles];
+                obstacleBoxes = new Physics::Box2D[3*numObstacles];
+                prevObstacleBoxes = obstacleBoxes + numObstacles;
+                restObstacleBoxes = obstacleBoxes + 2*numObstacles;
+                obstacleLeaves = new int32_t[numObstacles];
+                obstacleTree.reserve(numObstacles);
+                restTree.reserve(numObstacles);
+
+                for (uint i = 0; i < numObstacles; ++i) {
+                    Obstacle &o = obstacles[i];
+
+                    if (i < angledWalls.size()) {
+                        // baked into the wall distance field, so they are only kept here to be drawn
+                        o.rest = angledWalls[i];
+                        obstacleBoxes[i] = prevObstacleBoxes[i] = restObstacleBoxes[i] = o.rest;
+                        obstacleLeaves[i] = Physics::AABBTree::NONE;
+                        continue;
+                    }
+
+                    getline(f, line);
+
+                    ZMath::Vec2D min, max;
+                    float angle = 0.0f;
+
+                    if (sscanf(line.c_str(), "spin %f,%f|%f,%f %f,%f", &min.x, &min.y, &max.x, &max.y, &o.speed, &angle) >= 5) {
+                        o.motion = SPIN;
+
+                    } else {
+                        sscanf(line.c_str(), "slide %f,%f|%f,%f %f,%f,%f", &min.x, &min.y, &max.x, &max.y, &o.travel.x, &o.travel.y, &o.period);
+                        o.motion = SLIDE;
+                        if (o.period <= 0.0f) { o.period = 1.0f; }
+                    }
+
+                    o.rest = Physics::Box2D(offset + min, offset + max, angle);
+                    obstacleBoxes[i] = prevObstacleBoxes[i] = restObstacleBoxes[i] = o.rest;
+
+                    obstacleLeaves[i] = obstacleTree.insert(o.bounds(o.rest), i);
+                    restTree.insert(o.bounds(o.rest), i);
+                }
+            };
+
+            // A place where a ball touches a collider during a step.
+            struct Contact {
+                ZMath::Vec2D normal; // from the ball into the collider.
+                float depth; // how far the ball overlaps the collider along the normal when found.
+                ZMath::Vec2D surfaceVel; // velocity of the collider's surface where they touch.
+            };
+
+            static const uint MAX_CONTACTS = 16; // contacts kept per step. A ball can only touch a few colliders at once.
+            static const uint CONTACT_ITERATIONS = 4; // passes over the contacts, so resolving one does not undo another.
+            static constexpr float WALL_RESTITUTION = 1.0f; // fraction of the speed into a collider kept after bouncing off it.
+            static constexpr float WALL_FIELD_SPACING = 4.0f; // distance between samples of the wall distance field.
+            static constexpr float WALL_FIELD_RANGE = 64.0f; // distances in the wall field are clamped to this.
+            static const uint MAX_MARCH_STEPS = 8; // reads of the wall field when looking for where a ball first touches the walls.
+
+            /**
+             * @brief Find where a ball moving from one point to another first touches the walls.
+             *        The walls are at least the distance the field gives away from any point, less the radius, so the search
+             *        steps along the move by that much each time and can't step past a wall, however thin it is.
+             * 
+             * @param from Center of the ball at the start of the move.
+             * @param to Center of the ball at the end of the move.
+             * @param r Radius of the ball.
+             * @param k Set to the contact for the ball at the end of the move, pushing it back to where it first touched.
+             * @return Is there a contact?
+             */
+            bool wallContact(ZMath::Vec2D const &from, ZMath::Vec2D const &to, float r, Contact &k) const {
+                ZMath::Vec2D motion = to - from;
+                float len = motion.mag();
+                ZMath::Vec2D dir = len > 0.0f ? motion*(1.0f/len) : ZMath::Vec2D();
+
+                float s = 0.0f;
+                for (uint i = 0; i < MAX_MARCH_STEPS; ++i) {
+                    ZMath::Vec2D p = from + dir*s, gradient;
+                    float d = walls.sample(p, gradient);
+
+                    if (d < r) {
+                        float g = gradient.mag();
+                        if (g <= 0.0f) { return 0; }
+
+                        k.normal = gradient*(-1.0f/g);
+                        k.depth = r - d + (to - p)*k.normal; // also undo the part of the move past the touching point
+                        k.surfaceVel = ZMath::Vec2D();
+                        return 1;
+                    }
+
+                    if (s + d - r >= len) { return 0; } // the rest of the move is clear
+
+                    // a search that is still grazing the walls checks the end of the move last
+                    s = i + 2 < MAX_MARCH_STEPS ? s + d - r : len;
+                }
+
+                return 0;
+            };
+
+            // Find the contact between a ball and an obstacle, which may be moving.
+            static bool obstacleContact(Ball const &ball, Physics::Box2D const &box, Physics::Box2D const &prev, float dt, Contact &k) {
+                if (!Physics::CircleAndBox2D(ball.hitbox, box, k.normal, k.depth)) { return 0; }
+
+                // velocity of the touching point of the surface, from where that point was a step ago
+                k.surfaceVel = ZMath::Vec2D();
+
+                if (prev.pos != box.pos || prev.theta != box.theta) {
+                    ZMath::Vec2D contact = ball.hitbox.c + k.normal*(ball.hitbox.r - k.depth);
+                    ZMath::Vec2D local = box.rot.transpose() * (contact - box.pos);
+                    k.surfaceVel = (contact - (prev.rot * local + prev.pos)) * (1.0f/dt);
+                }
+
+                return 1;
+            };
+
+            /**
+             * @brief Resolve a ball's contacts one after another, a few times over.
+             *        Each contact pushes the ball out by however much it still overlaps (its depth less how far earlier contacts
+             *        already moved the ball along its normal), then removes the speed into the surface and adds it back out
+             *        scaled by the restitution. Both use max() rather than branches on the direction of the contact.
+             */
+            static void solveContacts(Ball &ball, Contact const* contacts, uint numContacts) {
+                ZMath::Vec2D start = ball.hitbox.c;
+
+                for (uint it = 0; it < CONTACT_ITERATIONS; ++it) {
+                    for (uint i = 0; i < numContacts; ++i) {
+                        Contact const &k = contacts[i];
+
+                        float overlap = k.depth + (ball.hitbox.c - start) * k.normal;
+                        ball.hitbox.c -= k.normal * ZMath::max(overlap, 0.0f);
+
+                        float vn = (ball.vel - k.surfaceVel) * k.normal;
+                        ball.vel -= k.normal * ((1.0f + WALL_RESTITUTION) * ZMath::max(vn, 0.0f));
+                    }
+                }
+            };
+
+
+            // Keep a finished run if it is among the best.
+            void keepRun() {
+                if (!run.complete()) { return; }
+
+                uint i = numBestRuns;
+                while (i > 0 && run.betterThan(bestRuns[i - 1])) { --i; }
+                if (i >= MAX_GHOSTS) { return; }
+
+                if (numBestRuns < MAX_GHOSTS) { numBestRuns++; }
+                for (uint j = numBestRuns - 1; j > i; --j) { bestRuns[j] = bestRuns[j - 1]; }
+                bestRuns[i] = run;
+            };
+
+            // Start a new run, replaying the best runs so far as ghosts.
+            void startRun() {
+                run.clear();
+                stepCount = 0;
+                restObstacles();
+                numGhosts = numBalls == 1 ? numBestRuns : 0; // ghosts are only raced in single player
+
+                for (uint i = 0; i < numGhosts; ++i) {
+                    Ghost &g = ghosts[i];
+                    g.ball = {{255, 255, 255, 90}, Physics::Circle(startingPos, balls[0].hitbox.r), ZMath::Vec2D(), startingPos};
+                    g.run = bestRuns[i];
+                    g.reader = Replay::Reader(g.run);
+                    g.hasShot = g.reader.next(g.shotStep, g.shotX, g.shotY);
+                    g.sunk = 0;
+                }
+            };
+
+            // Advance the ghosts by one physics step, taking their recorded shots on the steps they were taken.
+            void updateGhosts(float dt) {
+                for (uint i = 0; i < numGhosts; ++i) {
+                    Ghost &g = ghosts[i];
+                    if (g.sunk) { continue; }
+
+                    while (g.hasShot && g.shotStep == stepCount) {
+                        g.ball.vel = ZMath::Vec2D(g.shotX, g.shotY);
+                        g.ball.canHit = 1;
+                        g.hasShot = g.reader.next(g.shotStep, g.shotX, g.shotY);
+                    }
+
+                    g.sunk = step(g.ball, dt) == SUNK;
+                }
+            };
 
         public:
-            Stage() {};
+            Stage() { broadphase.reserve(MAX_BALLS); };
 
             // * Do not allow for the creation of the Stage objects through copy constructors or copy assignment operators.
 
@@ -78,32 +638,107 @@ namespace TrickShot {
             
             Stage& operator = (Stage const &Stage) { throw std::runtime_error("TrickShot::Stage objcts CANNOT be assigned or reassigned with '='."); };
 
+            // Free the grid and colliders and unload the textures so the stage can be initialized again.
+            void unload() {
+                unloadMap();
+
+                // unload the textures from the VRAM
+                if (wallText.id) { UnloadTexture(wallText); }
+                if (panelText.id) { UnloadTexture(panelText); }
+                if (sandText.id) { UnloadTexture(sandText); }
+                if (waterText.id) { UnloadTexture(waterText); }
+
+                wallText = panelText = sandText = waterText = {0};
+
+                // free images decoded by prepare() that were never uploaded
+                for (Image &image : images) {
+                    if (image.data) { UnloadImage(image); }
+                    image = {0};
+                }
+
+                imageBytes = 0;
+            };
+
             // Initialize a stage for the trickshot minigame.
             // This will randomly select one of the possible stages for the minigame.
             void init(std::string const &mappath) {
-                // Set the textures
-                Image image1 = LoadImage("assets/wall.png");
-                Image image2 = LoadImage("assets/boostPanel.png");
-                Image image3 = LoadImage("assets/sand.png");
-                Image image4 = LoadImage("assets/water.png");
-
-                ImageResize(&image1, 16, 16);
-                ImageResize(&image2, 16, 16);
-                ImageResize(&image3, 16, 16);
-                ImageResize(&image4, 16, 16);
-
-                wallText = LoadTextureFromImage(image1);
-                panelText = LoadTextureFromImage(image2);
-                sandText = LoadTextureFromImage(image3);
-                waterText = LoadTextureFromImage(image4);
-
-                UnloadImage(image1);
-                UnloadImage(image2);
-                UnloadImage(image3);
-                UnloadImage(image4);
-
-                // Set up the rest of the stage
+                TRACE_SCOPE("Stage::init", "load");
+
+                // free anything left over from a previous init
+                unload();
+
+                prepare(mappath);
+                upload();
+            };
+
+            /**
+             * @brief Decode the stage's images and load its map. This makes no GL calls, so it can run on any thread,
+             *        but upload() must be called on the main thread before the stage is drawn.
+             * 
+             * @param mappath Path to the .map file.
+             */
+            void prepare(std::string const &mappath) {
+                TRACE_SCOPE("Stage::prepare", "load");
+
+                {
+                    TRACE_SCOPE("decode images", "load");
+
+                    images[0] = LoadImage("assets/wall.png");
+                    images[1] = LoadImage("assets/boostPanel.png");
+                    images[2] = LoadImage("assets/sand.png");
+                    images[3] = LoadImage("assets/water.png");
+
+                    imageBytes = 0;
+                    for (Image &image : images) {
+                        imageBytes += GetPixelDataSize(image.width, image.height, image.format);
+                        ImageResize(&image, 16, 16);
+                    }
+                }
+
+                loadMap(mappath);
+            };
+
+            // Upload the images decoded by prepare() as textures, replacing any from a previous init. Main thread only.
+            void upload() {
+                TRACE_SCOPE("textures", "load");
+
+                // unload the textures from the VRAM
+                if (wallText.id) { UnloadTexture(wallText); }
+                if (panelText.id) { UnloadTexture(panelText); }
+                if (sandText.id) { UnloadTexture(sandText); }
+                if (waterText.id) { UnloadTexture(waterText); }
+
+                wallText = LoadTextureFromImage(images[0]);
+                panelText = LoadTextureFromImage(images[1]);
+                sandText = LoadTextureFromImage(images[2]);
+                waterText = LoadTextureFromImage(images[3]);
+
+                for (Image &image : images) {
+                    UnloadImage(image);
+                    image = {0};
+                }
+            };
+
+            /**
+             * @brief Load only the map (grid and colliders) of a stage. This does not need a window, so it can be used headless.
+             * 
+             * @param mappath Path to the .map file.
+             */
+            void loadMap(std::string const &mappath) {
                 std::ifstream f(mappath);
+                loadMap(f);
+            };
+
+            /**
+             * @brief Load only the map (grid and colliders) of a stage from a stream in the .map format.
+             * 
+             * @param f Stream to read the map from.
+             */
+            void loadMap(std::istream &f) {
+                TRACE_SCOPE("parse map", "load");
+
+                unloadMap();
+
                 std::string line;
 
                 getline(f, line);
@@ -137,122 +772,164 @@ namespace TrickShot {
                 for (uint i = 0; i < height; ++i) {
                     getline(f, line);
                     for (uint j = 0; j < width; ++j) {
+                        grid[i][j] = line[j];
+
                         if (line[j] == 'b') {
-                            ball = {WHITE, Physics::Circle(offset + ZMath::Vec2D(j*16 + 8.0f, i*16 + 8.0f), 8.0f), ZMath::Vec2D(), ball.hitbox.c};
-                            startingPos = ball.hitbox.c;
-                            continue;
-                        }
+                            startingPos = offset + ZMath::Vec2D(j*16 + 8.0f, i*16 + 8.0f);
 
-                        if (line[j] == 'h') {
+                        } else if (line[j] == 'h') {
                             hole = Physics::Circle(offset + ZMath::Vec2D(j*16 + 8.0f, i*16 + 8.0f), 8.0f);
-                            continue;
                         }
-
-                        grid[i][j] = line[j];
                     }
                 }
 
-                size_t i1, i2, i3;
+                // walls with an angle after a second '|' are kept aside as rotated boxes, and the other colliders packed down
+                std::vector<Physics::Box2D> angledWalls;
+
+                size_t i1, i2, i3, i4;
+                uint numTiles = 0;
                 for (uint i = 0; i < waterOffset; ++i) {
                     getline(f, line);
 
                     i1 = line.find(",");
                     i2 = line.find("|");
                     i3 = line.find(",", i2);
+                    i4 = line.find("|", i2 + 1);
+
+                    ZMath::Vec2D min = offset + ZMath::Vec2D(std::stof(line.substr(0, i1)), std::stof(line.substr(i1 + 1, i2)));
+                    ZMath::Vec2D max = offset + ZMath::Vec2D(std::stof(line.substr(i2 + 1, i3)), std::stof(line.substr(i3 + 1)));
 
-                    tiles[i] = Physics::AABB(
-                        offset + ZMath::Vec2D(std::stof(line.substr(0, i1)), std::stof(line.substr(i1 + 1, i2))),
-                        offset + ZMath::Vec2D(std::stof(line.substr(i2 + 1, i3)), std::stof(line.substr(i3 + 1)))
-                    );
+                    if (i < numWalls && i4 != std::string::npos) { angledWalls.push_back(Physics::Box2D(min, max, std::stof(line.substr(i4 + 1)))); }
+                    else { tiles[numTiles++] = Physics::AABB(min, max); }
                 }
+
+                numWalls -= angledWalls.size();
+                panelOffset = numWalls + numPanels;
+                sandOffset = numWalls + numPanels + numSand;
+                waterOffset = numWalls + numPanels + numSand + numWater;
+
+                loadObstacles(f, angledWalls);
+                buildWalls();
+
+                checksum = computeChecksum();
+                placeBalls();
+                formatHUD();
+
+                numBestRuns = 0;
+                startRun();
             };
 
             /**
-             * @brief Shoot the ball in the direction determined by the player releasing the mouse.
+             * @brief Shoot the ball of the player whose turn it is in the direction determined by the player releasing the mouse.
              * 
              * @param dm Change in the position of the mouse since it was pressed down.
              */
             inline void shoot(const ZMath::Vec2D &dm) {
-                ball.vel.set(dm);
-                strokes++;
-                canHit = 1;
+                // shots are whole pixels dragged (as mouse positions already are) so replays reproduce them exactly
+                int32_t dx = (int32_t) lroundf(dm.x), dy = (int32_t) lroundf(dm.y);
+                if (numBalls == 1) { run.record(stepCount, dx, dy); }
+
+                balls[turn].vel.set(ZMath::Vec2D(dx, dy));
+                balls[turn].canHit = 1;
+                strokes[turn]++;
+                shotPending = 1;
+                formatHUD();
             };
 
             /**
-             * @brief Update the position of the ball while its velocity is not 0.
+             * @brief Combine the materials of the tiles a circle overlaps: the most friction, the strongest boost, and any hazard.
+             *        A circle no wider than a tile covers at most 3 by 3 tiles, so this takes constant time.
              * 
-             * @param dt The time step passed. This should be standardized by the physics engine for determinism.
-             * @return 0 while the magnitude of the velocity is greater than the cut-off and 1 once its magnitude reaches that cut-off.
+             * @param c The circle.
+             * @return The combined material.
              */
-            bool update(float dt) {
-                ZMath::Vec2D n;
-                Physics::Line2D dP(ball.prevPos, ball.hitbox.c);
+            Material materialUnder(Physics::Circle const &c) const {
+                Material m;
 
-                // wall collisions
-                for (uint i = 0; i < numWalls; ++i) {
-                    ZMath::Vec2D min = tiles[i].getMin(), max = tiles[i].getMax();
-
-                    if (Physics::CircleAndAABB(ball.hitbox, tiles[i], n)) {        
-                        if (!ZMath::compare(n.x, 0) && !ZMath::compare(n.y, 0)) { // corner collision
-                            ball.vel = -ball.vel;
-                            ball.hitbox.c += ball.vel * dt;
-
-                        } else if (!ZMath::compare(n.x, 0)) {
-                            ball.vel.x = -ball.vel.x;
-                            ball.hitbox.c.x += ball.vel.x * dt; // apply the velocity a second time this iteration to ensure it escapes the wall.
-
-                        } else if (!ZMath::compare(n.y, 0)) {
-                            ball.vel.y = -ball.vel.y;
-                            ball.hitbox.c.y += ball.vel.y * dt; // apply the velocity a second time this iteration to ensure it escapes the wall.
-
-                        } else {
-                            if ((min.x > ball.prevPos.x && ball.hitbox.c.x > min.x) || (max.x < ball.prevPos.x && ball.hitbox.c.x < max.x)) {
-                                ball.vel.x = -ball.vel.x;
-                                ball.hitbox.c.x += ball.vel.x * dt;
-
-                            } else {
-                                ball.vel.y = -ball.vel.y;
-                                ball.hitbox.c.y += ball.vel.y * dt;
-                            }
-                        }
+                ZMath::Vec2D min = (c.c - offset - ZMath::Vec2D(c.r, c.r))*(1.0f/16), max = (c.c - offset + ZMath::Vec2D(c.r, c.r))*(1.0f/16);
+                int row0 = (int) floorf(ZMath::max(min.y, 0.0f)), row1 = (int) floorf(ZMath::min(max.y, height - 1.0f));
+                int col0 = (int) floorf(ZMath::max(min.x, 0.0f)), col1 = (int) floorf(ZMath::min(max.x, width - 1.0f));
 
-                    } else if ((ball.prevPos.x - tiles[i].pos.x) * (ball.hitbox.c.x - tiles[i].pos.x) < 0.0f &&
-                                ball.hitbox.c.y >= min.y && max.y >= ball.hitbox.c.y) {
-                        ball.vel.x = -ball.vel.x;
-                        ball.hitbox.c.x += ball.vel.x * dt;
+                for (int row = row0; row <= row1; ++row) {
+                    for (int col = col0; col <= col1; ++col) {
+                        Material const &tile = MATERIALS[(unsigned char) grid[row][col]];
+                        if (tile.friction == 1.0f && tile.boost == 1.0f && !tile.hazard) { continue; } // most tiles do nothing
 
-                    } else if ((ball.prevPos.y - tiles[i].pos.y) * (ball.hitbox.c.y - tiles[i].pos.y) < 0.0f &&
-                                ball.hitbox.c.x >= min.x && max.x >= ball.hitbox.c.x) {
-                        ball.vel.y = -ball.vel.y;
-                        ball.hitbox.c.y += ball.vel.y * dt;
-                    }
-                }
+                        Physics::AABB cell(offset + ZMath::Vec2D(col*16.0f, row*16.0f), offset + ZMath::Vec2D(col*16.0f + 16.0f, row*16.0f + 16.0f));
+                        if (!Physics::CircleAndAABB(c, cell)) { continue; }
 
-                // boost panels
-                for (uint i = numWalls; i < panelOffset; ++i) {
-                    if (Physics::CircleAndAABB(ball.hitbox, tiles[i])) {
-                        if (ball.vel.magSq() < 1000000.0f) { ball.vel *= 1.1f; }
+                        m.friction = ZMath::min(m.friction, tile.friction);
+                        m.boost = ZMath::max(m.boost, tile.boost);
+                        m.hazard = m.hazard || tile.hazard;
                     }
                 }
 
-                // sand
-                for (uint i = panelOffset; i < sandOffset; ++i) {
-                    if (Physics::CircleAndAABB(ball.hitbox, tiles[i])) { ball.vel *= 0.965f; }
+                return m;
+            };
+
+            /**
+             * @brief Advance a ball by one physics step on this stage, against the obstacles where they are now.
+             *        The stage itself is not modified, so this can be used to simulate shots without touching the ball being played.
+             *        The obstacles are moved by update(), so only call this from the thread that updates the stage.
+             * 
+             * @param ball The ball to move. Call it with a copy of the ball to simulate.
+             * @param dt The time step passed. This should be standardized by the physics engine for determinism.
+             * @return What happened to the ball during the step.
+             */
+            inline StepResult step(Ball &ball, float dt) const { return step(ball, dt, obstacleBoxes, prevObstacleBoxes, obstacleTree); };
+
+            /**
+             * @brief Advance a ball by one physics step against a given set of obstacle poses.
+             * 
+             * @param ball The ball to move.
+             * @param dt The time step passed.
+             * @param boxes Pose of each obstacle.
+             * @param prevBoxes Pose of each obstacle a step earlier, to find how fast their surfaces move.
+             * @param tree Bounds of the obstacles in those poses.
+             * @return What happened to the ball during the step.
+             */
+            StepResult step(Ball &ball, float dt, Physics::Box2D const* boxes, Physics::Box2D const* prevBoxes, Physics::AABBTree const &tree) const {
+                Contact contacts[MAX_CONTACTS];
+                uint numContacts = 0;
+
+                // walls, including ones the ball would have passed through since the last step
+                bool touchedWalls = wallContact(ball.prevPos, ball.hitbox.c, ball.hitbox.r, contacts[numContacts]);
+                if (touchedWalls) { numContacts++; }
+
+                // obstacles near the ball
+                Physics::AABB near(ball.hitbox.c - ZMath::Vec2D(ball.hitbox.r, ball.hitbox.r), ball.hitbox.c + ZMath::Vec2D(ball.hitbox.r, ball.hitbox.r));
+                tree.query(near, [&](uint32_t i) {
+                    if (numContacts < MAX_CONTACTS && obstacleContact(ball, boxes[i], prevBoxes[i], dt, contacts[numContacts])) { numContacts++; }
+                });
+
+                solveContacts(ball, contacts, numContacts);
+
+                // The field gives one normal per read, so a ball in an inside corner is only pushed off one of the walls at
+                //  first. Reading it again where the ball ended up finds the other.
+                for (uint i = 1; touchedWalls && i < CONTACT_ITERATIONS; ++i) {
+                    Contact k;
+                    if (!wallContact(ball.hitbox.c, ball.hitbox.c, ball.hitbox.r, k)) { break; }
+                    solveContacts(ball, &k, 1);
                 }
 
-                // water
-                for (uint i = sandOffset; i < waterOffset; ++i) {
-                    if (Physics::CircleAndAABB(ball.hitbox, tiles[i])) {
-                        ball.hitbox.c = startingPos;
-                        ball.vel.zero();
-                        return 1;
-                    }
+                // boost panels, sand, and water, from the tiles under the ball
+                Material m = materialUnder(ball.hitbox);
+                if (ball.vel.magSq() < MAX_BOOST_SPEED*MAX_BOOST_SPEED) { ball.vel *= m.boost; }
+                ball.vel *= m.friction;
+
+                if (m.hazard) {
+                    // prevPos too, or the next step's sweep runs from the water to the tee and catches the walls in between
+                    ball.hitbox.c = startingPos;
+                    ball.prevPos = startingPos;
+                    ball.vel.zero();
+                    return WATER;
                 }
 
-                if (canHit && Physics::CircleInCircle(ball.hitbox, hole)) {
-                    if (ball.vel.magSq() <= 20000.0f) { complete = 1; return 0; }
+                if (ball.canHit && Physics::CircleInCircle(ball.hitbox, hole)) {
+                    if (ball.vel.magSq() <= 20000.0f) { return SUNK; }
+
                     ball.vel *= 0.35f;
-                    canHit = 0;
+                    ball.canHit = 0;
                 }
 
                 ball.prevPos = ball.hitbox.c;
@@ -261,12 +938,79 @@ namespace TrickShot {
 
                 if (ball.vel.magSq() <= 100.0f) {
                     ball.vel.zero();
-                    return 1;
+                    return STOPPED;
                 }
 
-                return 0;
+                return MOVING;
             };
 
+            /**
+             * @brief Simulate a shot on this stage until it stops, sinks, or lands in the water.
+             *        Obstacles are held at their rest poses, so this is safe to call from several threads at once.
+             * 
+             * @param ball The ball to move, with its velocity set to the shot. Call it with a copy of the ball to simulate.
+             * @param dt The time step passed.
+             * @param maxSteps A ball still moving after this many steps is left where it is.
+             * @return How the shot ended. MOVING if it ran out of steps.
+             */
+            StepResult simulate(Ball &ball, float dt, uint maxSteps) const {
+                StepResult res = MOVING;
+                for (uint s = 0; s < maxSteps && res == MOVING; ++s) { res = step(ball, dt, restObstacleBoxes, restObstacleBoxes, restTree); }
+                return res;
+            };
+
+            /**
+             * @brief Update the positions of the balls while any of them is moving, then pass the turn on.
+             * 
+             * @param dt The time step passed. This should be standardized by the physics engine for determinism.
+             * @return 0 while any ball's velocity is greater than the cut-off and 1 once every ball has stopped.
+             */
+            bool update(float dt) {
+                moveObstacles(stepCount*dt);
+                updateGhosts(dt);
+                if (complete) { return 0; }
+
+                bool moving = 0, allSunk = 1;
+
+                for (uint i = 0; i < numBalls; ++i) {
+                    if (!onCourse[i] || sunk[i]) { allSunk &= sunk[i]; continue; }
+
+                    StepResult res = step(balls[i], dt);
+                    if (res == SUNK) { sunk[i] = 1; }
+                    else { allSunk = 0; moving |= res == MOVING; }
+                }
+
+                collideBalls();
+                stepCount++;
+
+                if (allSunk) {
+                    complete = 1;
+                    formatHUD();
+
+                    if (numBalls == 1) {
+                        run.finish(stepCount);
+                        keepRun();
+                    }
+
+                    return 0;
+                }
+
+                // a collision may have set a resting ball moving
+                for (uint i = 0; i < numBalls && !moving; ++i) { moving = onCourse[i] && !sunk[i] && balls[i].vel != ZMath::Vec2D(); }
+                if (moving) { return 0; }
+
+                if (shotPending) {
+                    shotPending = 0;
+
+                    do { turn = (turn + 1) % numBalls; } while (sunk[turn]);
+                    onCourse[turn] = 1;
+                    formatHUD();
+                }
+
+                return 1;
+            };
+
+
             // Draw the tiles associated with the stage.
             inline void draw() const {
                 DrawRectangle(offset.x, offset.y, 16.0f*width, 16.0f*height, {0, 145, 50, 255});
@@ -283,45 +1027,109 @@ namespace TrickShot {
                 }
 
                 DrawCircle(hole.c.x, hole.c.y, hole.r, BLACK);
-                DrawCircle(ball.hitbox.c.x, ball.hitbox.c.y, ball.hitbox.r, ball.color);
 
-                if (complete) {
-                    std::ostringstream sout;
-                    if (strokes == 2) { sout << "Hole in One!"; }
-                    else { sout << "You made it in " << (strokes - 1) << " strokes!"; }
-                    int textWidth = MeasureText(sout.str().c_str(), 50);
+                for (uint i = 0; i < numObstacles; ++i) {
+                    Physics::Box2D const &box = obstacleBoxes[i];
+                    ZMath::Vec2D h = box.getHalfsize();
+                    Color color = obstacles[i].motion == FIXED ? Color{80, 80, 80, 255} : Color{120, 80, 45, 255};
+                    DrawRectanglePro({box.pos.x, box.pos.y, 2.0f*h.x, 2.0f*h.y}, {h.x, h.y}, box.theta, color);
+                }
+
+                for (uint i = 0; i < numGhosts; ++i) {
+                    if (!ghosts[i].sunk) { DrawCircle(ghosts[i].ball.hitbox.c.x, ghosts[i].ball.hitbox.c.y, ghosts[i].ball.hitbox.r, ghosts[i].ball.color); }
+                }
+
+                for (uint i = 0; i < numBalls; ++i) {
+                    if (onCourse[i] && !sunk[i]) { DrawCircle(balls[i].hitbox.c.x, balls[i].hitbox.c.y, balls[i].hitbox.r, balls[i].color); }
+                }
 
-                    DrawText(sout.str().c_str(), (1800 - textWidth)/2, 425, 50, WHITE);
+                if (complete) {
+                    int textWidth = MeasureText(hudText, 50);
+                    DrawText(hudText, (1800 - textWidth)/2, 425, 50, WHITE);
 
                 } else {
-                    std::ostringstream sout;
-                    sout << "Stroke: " << strokes;
-                    DrawText(sout.str().c_str(), 10, 10, 30, WHITE);
+                    DrawText(hudText, 10, 10, 30, WHITE);
                 }
             };
 
             inline void reset() {
-                ball.hitbox.c = startingPos;
-                ball.prevPos = startingPos;
-                ball.vel.zero();
+                placeBalls();
+                formatHUD();
 
-                strokes = 1;
-                canHit = 0;
-                complete = 0;
+                startRun();
             };
 
-            ~Stage() {
-                // free the memory
-                for (uint i = 0; i < height; ++i) { delete[] grid[i]; }
-                delete[] grid;
-                delete[] tiles;
+            // * Set the number of players, from 1 to MAX_BALLS, and restart the stage.
+            inline void setPlayers(uint n) {
+                numBalls = n < 1 ? 1 : (n > MAX_BALLS ? MAX_BALLS : n);
+                reset();
+            };
 
-                // unload the textures from the VRAM
-                UnloadTexture(wallText);
-                UnloadTexture(panelText);
-                UnloadTexture(sandText);
-                UnloadTexture(waterText);
+            inline uint getPlayers() const { return numBalls; };
+
+            // * Map queries used by tools that analyse a stage.
+
+            // Tile character at a grid position (see assets/maps/map.info for the legend).
+            inline char tileAt(uint row, uint col) const { return grid[row][col]; };
+
+            /**
+             * @brief Find the first wall tile along a ray, walking only the tiles the ray passes through.
+             *        Walls at an angle and moving obstacles are not included.
+             * 
+             * @param ray The ray. Its direction must be normalized.
+             * @param maxDist How far along the ray to look.
+             * @param hit Set to the hit: its distance, the point and face the ray entered the wall through, and the tile.
+             * @return Is there a hit?
+             */
+            inline bool raycast(Physics::Ray2D const &ray, float maxDist, Physics::RayHit &hit) const {
+                return Physics::raycast(ray, offset, 16.0f, width, height, [this](int row, int col) { return wallTiles[row*width + col]; }, maxDist, hit);
             };
+
+            /**
+             * @brief Cast many rays, such as a fan of aim directions or lines of sight from many tiles.
+             * 
+             * @param rays The rays. Their directions must be normalized.
+             * @param n Number of rays.
+             * @param maxDist How far along each ray to look.
+             * @param hits Set to the hit of each ray. A ray that hits nothing gets a distance of -1.
+             * @return Number of rays that hit a wall.
+             */
+            uint raycast(Physics::Ray2D const* rays, uint n, float maxDist, Physics::RayHit* hits) const {
+                uint numHits = 0;
+                for (uint i = 0; i < n; ++i) { numHits += raycast(rays[i], maxDist, hits[i]); }
+                return numHits;
+            };
+
+            // Screen position of the top left corner of the grid.
+            inline ZMath::Vec2D getOffset() const { return offset; };
+
+            // Position the ball starts at and returns to after landing in water.
+            inline ZMath::Vec2D getStartingPos() const { return startingPos; };
+
+            // The ball of the player whose turn it is.
+            inline Ball const& getBall() const { return balls[turn]; };
+
+            // Hash of the map's layout and colliders. Maps with the same checksum play identically.
+            inline uint64_t getChecksum() const { return checksum; };
+
+            // Get the memory used by this stage.
+            MemoryUsage memoryUsage() const {
+                MemoryUsage mem;
+
+                if (grid) { mem.grid = height*sizeof(char*) + height*width*sizeof(char); }
+                if (wallTiles) { mem.grid += height*width*sizeof(bool); }
+                if (tiles) { mem.colliders = waterOffset*sizeof(Physics::AABB); }
+                mem.colliders += walls.bytes();
+                mem.colliders += numObstacles*(sizeof(Obstacle) + 3*sizeof(Physics::Box2D) + sizeof(int32_t));
+
+                mem.images = imageBytes;
+                mem.textures = textureBytes(wallText) + textureBytes(panelText) + textureBytes(sandText) + textureBytes(waterText);
+                mem.overhead = sizeof(Stage);
+
+                return mem;
+            };
+
+            ~Stage() { unload(); };
     };
 }
 
@@ -0,0 +1,213 @@
+#ifndef TRICKSHOTGAME_H
+#define TRICKSHOTGAME_H
+
+#include <memory>
+#include "arena.h"
+#include "distfield.h"
+#include "jobs.h"
+#include "memreport.h"
+#include "minigame.h"
+#include "trickshot.h"
+
+// * =======================
+// * Trick Shot Mini-Game
+// * =======================
+
+namespace TrickShot {
+    static const uint NUM_STAGES = 5;
+
+    // * The trick shot stages played in order, looping back to the first after the last.
+    class Game : public MiniGame {
+        private:
+            Stage stages[NUM_STAGES];
+            Jobs::Handle loadJobs[NUM_STAGES]; // texture upload of each stage, after its images are decoded and map parsed.
+            uint numLoaded = 0; // stages loaded so far.
+            uint currStage = 0;
+            uint players = 1; // hot-seat players on every stage.
+
+            // stroke-to-hole distance fields, built in the background when a stage is first played and cached next to the map
+            std::unique_ptr<DistField::Field> fields[NUM_STAGES];
+
+            // used to track delta mouse
+            ZMath::Vec2D startMPos;
+
+            // flag bool used to determine if the player can input
+            bool flag = 1;
+
+            // par display and shot hint toggled with H
+            bool showHint = 0;
+            uint8_t shownPar = DistField::UNREACHED - 1;
+            char parText[32];
+            static const uint HINT_STEPS = 600; // physics steps of the hinted shot drawn.
+            static constexpr float AIM_LENGTH = 480.0f; // length of the aim preview drawn while dragging.
+
+            // Draw the line a shot would leave along, up to where the ball would first touch a wall, then its bounce off it.
+            // Only the center of the ball is traced, and sand, boosts, and obstacles are left out, so it is a guide rather than a prediction.
+            void drawAim(ZMath::Vec2D const &drag) const {
+                Stage const &stage = stages[currStage];
+                Ball const &ball = stage.getBall();
+
+                Physics::Ray2D ray(ball.hitbox.c, drag.normalize());
+                float reach = AIM_LENGTH;
+
+                for (uint bounce = 0; bounce < 2; ++bounce) {
+                    Physics::RayHit hit;
+                    float t = reach;
+
+                    // the ball touches the face a radius before its center would reach it
+                    if (stage.raycast(ray, reach, hit)) { t = ZMath::max(hit.dist - ball.hitbox.r/ZMath::abs(ray.dir * hit.normal), 0.0f); }
+
+                    ZMath::Vec2D end = ray.origin + ray.dir*t;
+                    DrawLineEx({ray.origin.x, ray.origin.y}, {end.x, end.y}, 2.0f, ball.color);
+
+                    if (hit.dist < 0.0f) { break; }
+
+                    DrawCircleLines(end.x, end.y, ball.hitbox.r, ball.color);
+                    reach -= t;
+                    ray = Physics::Ray2D(end, ray.dir.reflect(hit.normal));
+                }
+            };
+
+            // Start building (or loading) the distance field of the current stage.
+            void startField() {
+                if (!fields[currStage]) {
+                    fields[currStage] = std::make_unique<DistField::Field>();
+                    fields[currStage]->start(stages[currStage], DistField::fieldPath(MAP_PATHS[currStage]));
+                }
+
+                shownPar = DistField::UNREACHED - 1;
+            };
+
+        public:
+            static constexpr const char* MAP_PATHS[NUM_STAGES] = {"assets/maps/map1.map", "assets/maps/map2.map", "assets/maps/map3.map",
+                                                                  "assets/maps/map4.map", "assets/maps/map5.map"};
+
+            Game(uint players = 1) : players(players) {};
+
+            inline const char* name() const override { return "Trick Shot"; };
+
+            // The stages are decoded and parsed as jobs on every core, and their textures uploaded on the main thread.
+            // Each call runs at most one job on the main thread.
+            bool load() override {
+                Jobs::System &jobs = Jobs::get();
+
+                if (!loadJobs[0]) {
+                    for (uint i = 0; i < NUM_STAGES; ++i) {
+                        Stage* stage = &stages[i];
+
+                        Jobs::Handle prepare = jobs.submit([stage, i] { stage->prepare(MAP_PATHS[i]); });
+                        loadJobs[i] = jobs.submit([stage] { stage->upload(); }, {prepare}, Jobs::MAIN);
+                    }
+                }
+
+                if (!jobs.runMainThreadJobs(1)) { jobs.runOne(); }
+
+                numLoaded = 0;
+                while (numLoaded < NUM_STAGES && loadJobs[numLoaded]->finished()) { numLoaded++; }
+                if (numLoaded < NUM_STAGES) { return 0; }
+
+                for (Jobs::Handle &job : loadJobs) { job.reset(); }
+                for (uint i = 0; i < NUM_STAGES; ++i) { stages[i].setPlayers(players); }
+
+                currStage = 0;
+                flag = 1;
+                startField();
+                return 1;
+            };
+
+            inline void step(float dt) override { flag = stages[currStage].update(dt); };
+
+            void update() override {
+                // check for mouse dragging
+                if (flag) {
+                    if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
+                        startMPos.x = GetMouseX();
+                        startMPos.y = GetMouseY();
+                    }
+
+                    if (IsMouseButtonReleased(MOUSE_BUTTON_LEFT)) {
+                        ZMath::Vec2D dP = ZMath::Vec2D(startMPos.x - GetMouseX(), startMPos.y - GetMouseY());
+                        if (dP.magSq() >= 550.0f) { stages[currStage].shoot(dP); }
+                    }
+                }
+
+                if (IsKeyPressed(KEY_H)) { showHint = !showHint; }
+
+                if (stages[currStage].complete && IsMouseButtonReleased(MOUSE_BUTTON_LEFT)) {
+                    currStage++;
+                    if (currStage == NUM_STAGES) {
+                        for (uint i = 0; i < NUM_STAGES; ++i) { stages[i].reset(); }
+                        currStage = 0;
+                    }
+
+                    startField();
+                }
+
+                uint8_t par = fields[currStage]->par();
+                if (par != shownPar) {
+                    if (par != DistField::UNREACHED) { snprintf(parText, sizeof(parText), "Par: %u", par); }
+                    else { snprintf(parText, sizeof(parText), "Par: ..."); }
+                    shownPar = par;
+                }
+            };
+
+            void draw() const override {
+                stages[currStage].draw();
+
+                DrawText(parText, GetScreenWidth() - MeasureText(parText, 30) - 10, 10, 30, WHITE);
+
+                if (flag && !stages[currStage].complete && IsMouseButtonDown(MOUSE_BUTTON_LEFT)) {
+                    ZMath::Vec2D drag(startMPos.x - GetMouseX(), startMPos.y - GetMouseY());
+                    if (drag.magSq() >= 550.0f) { drawAim(drag); }
+                }
+
+                if (showHint && flag && !stages[currStage].complete) {
+                    ZMath::Vec2D ballPos = stages[currStage].getBall().hitbox.c, shot;
+
+                    if (fields[currStage]->hint(ballPos, shot) != DistField::UNREACHED) {
+                        // predicted path of the hinted shot, a per-frame temporary kept in the frame arena
+                        Ball ball = stages[currStage].getBall();
+                        ball.hitbox.c = ballPos;
+                        ball.prevPos = ballPos;
+                        ball.vel = shot;
+                        ball.canHit = 1;
+
+                        Arena::Vector<Vector2> path;
+                        path.push_back({ballPos.x, ballPos.y});
+
+                        for (uint s = 0; s < HINT_STEPS; ++s) {
+                            StepResult res = stages[currStage].step(ball, 0.0167f);
+                            if (res == WATER) { break; }
+
+                            if (s % 3 == 2 || res != MOVING) { path.push_back({ball.hitbox.c.x, ball.hitbox.c.y}); }
+                            if (res != MOVING) { break; }
+                        }
+
+                        DrawLineStrip(path.data(), path.size(), YELLOW);
+                        DrawCircle(path.back().x, path.back().y, 4.0f, YELLOW);
+                    }
+                }
+            };
+
+            void unload() override {
+                // stop the background builds before the stages they read are freed
+                for (uint i = 0; i < NUM_STAGES; ++i) { fields[i].reset(); }
+
+                // finish loading stages that are part way through, so no job is left using them
+                for (Jobs::Handle &job : loadJobs) {
+                    Jobs::get().wait(job);
+                    job.reset();
+                }
+
+                for (uint i = 0; i < NUM_STAGES; ++i) { stages[i].unload(); }
+                numLoaded = 0;
+            };
+
+            inline void formatMemory(char* buf, size_t size) const override { MemReport::format(buf, size, stages, numLoaded); };
+
+            // The stage being played.
+            inline Stage& stage() { return stages[currStage]; };
+    };
+}
+
+#endif // !TRICKSHOTGAME_H
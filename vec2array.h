@@ -0,0 +1,378 @@
+#ifndef VEC2ARRAY_H
+#define VEC2ARRAY_H
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+#include "dispatch.h"
+#include "zmath.h"
+
+// * =====================================
+// * Structure of Arrays 2D Vectors
+// * =====================================
+
+// ? Vec2Array stores many 2D vectors as separate x and y arrays. Arithmetic on it builds lazy expressions that are
+// ?  only evaluated when assigned to a Vec2Array (or reduced), so a chain like `out = rot * (a + b) * 0.5f` runs as
+// ?  one fused loop without temporaries.
+// ? The loops are written so the compiler can vectorize them, and are compiled for every SIMD level in dispatch.h.
+// ?  The best level the CPU supports is used, and every level gives bit-identical results.
+// ? Note: sqrt (used by normalize) is only vectorized when compiling with -fno-math-errno, as the Makefile does.
+// ? Note: expressions hold arrays by reference, so do not store an expression (e.g. with auto) that refers to a
+// ?  temporary Vec2Array. Assign or reduce it in the same statement instead.
+// ? Both sides of + and - between expressions must be the same size. This is asserted rather than checked in the loops.
+
+namespace ZMath {
+    class Vec2Array;
+
+    // * Base class of every Vec2Array expression. E must provide size(), x(i), and y(i).
+    template <typename E>
+    class Vec2Expr {
+        public:
+            constexpr E const& self() const { return static_cast<E const&>(*this); };
+
+            constexpr size_t size() const { return self().size(); };
+            constexpr float x(size_t i) const { return self().x(i); };
+            constexpr float y(size_t i) const { return self().y(i); };
+    };
+
+    namespace Detail {
+        // Arrays are held by reference inside expressions. Everything else is a temporary node and is held by value.
+        template <typename E> struct ExprRef { using type = E; };
+        template <> struct ExprRef<Vec2Array> { using type = Vec2Array const&; };
+
+        template <typename E> using ExprRefT = typename ExprRef<E>::type;
+    }
+
+    // * Element-wise sum of two expressions.
+    template <typename A, typename B>
+    class Vec2Sum : public Vec2Expr<Vec2Sum<A, B>> {
+        private:
+            Detail::ExprRefT<A> a;
+            Detail::ExprRefT<B> b;
+
+        public:
+            constexpr Vec2Sum(A const &a, B const &b) : a(a), b(b) { assert(a.size() == b.size()); };
+
+            constexpr size_t size() const { return a.size(); };
+            ZMATH_INLINE constexpr float x(size_t i) const { return a.x(i) + b.x(i); };
+            ZMATH_INLINE constexpr float y(size_t i) const { return a.y(i) + b.y(i); };
+    };
+
+    // * Element-wise difference of two expressions.
+    template <typename A, typename B>
+    class Vec2Diff : public Vec2Expr<Vec2Diff<A, B>> {
+        private:
+            Detail::ExprRefT<A> a;
+            Detail::ExprRefT<B> b;
+
+        public:
+            constexpr Vec2Diff(A const &a, B const &b) : a(a), b(b) { assert(a.size() == b.size()); };
+
+            constexpr size_t size() const { return a.size(); };
+            ZMATH_INLINE constexpr float x(size_t i) const { return a.x(i) - b.x(i); };
+            ZMATH_INLINE constexpr float y(size_t i) const { return a.y(i) - b.y(i); };
+    };
+
+    // * The same vector added to every element.
+    template <typename A>
+    class Vec2Offset : public Vec2Expr<Vec2Offset<A>> {
+        private:
+            Detail::ExprRefT<A> a;
+            Vec2D v;
+
+        public:
+            constexpr Vec2Offset(A const &a, Vec2D const &v) : a(a), v(v) {};
+
+            constexpr size_t size() const { return a.size(); };
+            ZMATH_INLINE constexpr float x(size_t i) const { return a.x(i) + v.x; };
+            ZMATH_INLINE constexpr float y(size_t i) const { return a.y(i) + v.y; };
+    };
+
+    // * Every element scaled by a constant.
+    template <typename A>
+    class Vec2Scale : public Vec2Expr<Vec2Scale<A>> {
+        private:
+            Detail::ExprRefT<A> a;
+            float c;
+
+        public:
+            constexpr Vec2Scale(A const &a, float c) : a(a), c(c) {};
+
+            constexpr size_t size() const { return a.size(); };
+            ZMATH_INLINE constexpr float x(size_t i) const { return c*a.x(i); };
+            ZMATH_INLINE constexpr float y(size_t i) const { return c*a.y(i); };
+    };
+
+    // * Every element multiplied by a matrix.
+    template <typename A>
+    class Vec2Transform : public Vec2Expr<Vec2Transform<A>> {
+        private:
+            Mat2D m;
+            Detail::ExprRefT<A> a;
+
+        public:
+            constexpr Vec2Transform(Mat2D const &m, A const &a) : m(m), a(a) {};
+
+            constexpr size_t size() const { return a.size(); };
+            ZMATH_INLINE constexpr float x(size_t i) const { return m.c1.x*a.x(i) + m.c2.x*a.y(i); };
+            ZMATH_INLINE constexpr float y(size_t i) const { return m.c1.y*a.x(i) + m.c2.y*a.y(i); };
+    };
+
+    // * Every element normalized. Matches Vec2D::normalize.
+    template <typename A>
+    class Vec2Normalize : public Vec2Expr<Vec2Normalize<A>> {
+        private:
+            Detail::ExprRefT<A> a;
+
+            ZMATH_INLINE float inv(size_t i) const {
+                float x = a.x(i), y = a.y(i);
+
+                #ifdef ZMATH_FAST_MATH
+                    return Fast::rsqrt(x*x + y*y);
+                #else
+                    return 1.0f/sqrtf(x*x + y*y);
+                #endif
+            };
+
+        public:
+            constexpr Vec2Normalize(A const &a) : a(a) {};
+
+            constexpr size_t size() const { return a.size(); };
+            ZMATH_INLINE float x(size_t i) const { return a.x(i) * inv(i); };
+            ZMATH_INLINE float y(size_t i) const { return a.y(i) * inv(i); };
+    };
+
+    // * Every element clamped between a min and max vector. Matches ZMath::clamp.
+    template <typename A>
+    class Vec2Clamp : public Vec2Expr<Vec2Clamp<A>> {
+        private:
+            Detail::ExprRefT<A> a;
+            Vec2D min, max;
+
+        public:
+            constexpr Vec2Clamp(A const &a, Vec2D const &min, Vec2D const &max) : a(a), min(min), max(max) {};
+
+            constexpr size_t size() const { return a.size(); };
+            ZMATH_INLINE constexpr float x(size_t i) const { return ZMath::max(ZMath::min(a.x(i), max.x), min.x); };
+            ZMATH_INLINE constexpr float y(size_t i) const { return ZMath::max(ZMath::min(a.y(i), max.y), min.y); };
+    };
+
+    // * ============================================
+    // * Expression Operators
+    // * ============================================
+
+    template <typename A, typename B>
+    constexpr Vec2Sum<A, B> operator + (Vec2Expr<A> const &a, Vec2Expr<B> const &b) { return Vec2Sum<A, B>(a.self(), b.self()); };
+
+    template <typename A, typename B>
+    constexpr Vec2Diff<A, B> operator - (Vec2Expr<A> const &a, Vec2Expr<B> const &b) { return Vec2Diff<A, B>(a.self(), b.self()); };
+
+    template <typename A>
+    constexpr Vec2Offset<A> operator + (Vec2Expr<A> const &a, Vec2D const &v) { return Vec2Offset<A>(a.self(), v); };
+
+    template <typename A>
+    constexpr Vec2Offset<A> operator - (Vec2Expr<A> const &a, Vec2D const &v) { return Vec2Offset<A>(a.self(), -v); };
+
+    template <typename A>
+    constexpr Vec2Scale<A> operator * (Vec2Expr<A> const &a, float c) { return Vec2Scale<A>(a.self(), c); };
+
+    template <typename A>
+    constexpr Vec2Scale<A> operator * (float c, Vec2Expr<A> const &a) { return Vec2Scale<A>(a.self(), c); };
+
+    template <typename A>
+    constexpr Vec2Transform<A> operator * (Mat2D const &m, Vec2Expr<A> const &a) { return Vec2Transform<A>(m, a.self()); };
+
+    // * Normalize every element of an expression.
+    template <typename A>
+    constexpr Vec2Normalize<A> normalize(Vec2Expr<A> const &a) { return Vec2Normalize<A>(a.self()); };
+
+    // * Clamp every element of an expression between a min and max vector.
+    template <typename A>
+    constexpr Vec2Clamp<A> clamp(Vec2Expr<A> const &a, Vec2D const &min, Vec2D const &max) { return Vec2Clamp<A>(a.self(), min, max); };
+
+
+    // * ============================================
+    // * Evaluation Kernels
+    // * ============================================
+
+    namespace Detail {
+        // Number of independent accumulators used by reductions.
+        // Fixed so every target adds in the same order and returns the same result.
+        static const size_t LANES = 8;
+
+        template <typename E>
+        ZMATH_INLINE void evaluateLoop(E const &e, float* xs, float* ys, size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                // read both components before writing so expressions that read the destination stay correct.
+                float x = e.x(i), y = e.y(i);
+                xs[i] = x;
+                ys[i] = y;
+            }
+        };
+
+        template <typename E>
+        ZMATH_INLINE float sumDistSqLoop(E const &e, Vec2D const &p, size_t n) {
+            float acc[LANES] = {};
+            size_t i = 0;
+
+            for (; i + LANES <= n; i += LANES) {
+                for (size_t j = 0; j < LANES; ++j) {
+                    float dx = e.x(i + j) - p.x, dy = e.y(i + j) - p.y;
+                    acc[j] += dx*dx + dy*dy;
+                }
+            }
+
+            for (size_t j = 0; i < n; ++i, ++j) {
+                float dx = e.x(i) - p.x, dy = e.y(i) - p.y;
+                acc[j] += dx*dx + dy*dy;
+            }
+
+            float sum = 0.0f;
+            for (size_t j = 0; j < LANES; ++j) { sum += acc[j]; }
+            return sum;
+        };
+
+        template <typename E>
+        ZMATH_INLINE float minDistSqLoop(E const &e, Vec2D const &p, size_t n) {
+            float acc[LANES];
+            for (size_t j = 0; j < LANES; ++j) { acc[j] = std::numeric_limits<float>::infinity(); }
+            size_t i = 0;
+
+            for (; i + LANES <= n; i += LANES) {
+                for (size_t j = 0; j < LANES; ++j) {
+                    float dx = e.x(i + j) - p.x, dy = e.y(i + j) - p.y;
+                    float d = dx*dx + dy*dy;
+                    acc[j] = d < acc[j] ? d : acc[j];
+                }
+            }
+
+            for (size_t j = 0; i < n; ++i, ++j) {
+                float dx = e.x(i) - p.x, dy = e.y(i) - p.y;
+                float d = dx*dx + dy*dy;
+                acc[j] = d < acc[j] ? d : acc[j];
+            }
+
+            float min = acc[0];
+            for (size_t j = 1; j < LANES; ++j) { min = acc[j] < min ? acc[j] : min; }
+            return min;
+        };
+
+        ZMATH_MULTIVERSION(template <typename E>, void, evaluate, (E const &e, float* xs, float* ys, size_t n), (e, xs, ys, n), evaluateLoop)
+        ZMATH_MULTIVERSION(template <typename E>, float, sumDistSq, (E const &e, Vec2D const &p, size_t n), (e, p, n), sumDistSqLoop)
+        ZMATH_MULTIVERSION(template <typename E>, float, minDistSq, (E const &e, Vec2D const &p, size_t n), (e, p, n), minDistSqLoop)
+    }
+
+
+    // * ============================================
+    // * Vec2Array
+    // * ============================================
+
+    class Vec2Array : public Vec2Expr<Vec2Array> {
+        private:
+            std::vector<float> xs, ys;
+
+        public:
+            Vec2Array() = default;
+
+            // * Create an array of n zero vectors.
+            explicit Vec2Array(size_t n) : xs(n), ys(n) {};
+
+            // * Create an array from n Vec2D objects.
+            Vec2Array(Vec2D const* vecs, size_t n) : xs(n), ys(n) {
+                for (size_t i = 0; i < n; ++i) {
+                    xs[i] = vecs[i].x;
+                    ys[i] = vecs[i].y;
+                }
+            };
+
+            // * Evaluate an expression into a new array.
+            template <typename E>
+            Vec2Array(Vec2Expr<E> const &e) { (*this) = e; };
+
+            // * Evaluate an expression into this array in a single fused loop.
+            template <typename E>
+            Vec2Array& operator = (Vec2Expr<E> const &e) {
+                size_t n = e.size();
+
+                // an expression that reads this array must not see it resized.
+                if (n != size()) { resize(n); }
+
+                ZMATH_DISPATCH_CALL(Detail::evaluate, e.self(), xs.data(), ys.data(), n);
+                return (*this);
+            };
+
+            template <typename E> Vec2Array& operator += (Vec2Expr<E> const &e) { assert(e.size() == size()); return (*this) = (*this) + e; };
+            template <typename E> Vec2Array& operator -= (Vec2Expr<E> const &e) { assert(e.size() == size()); return (*this) = (*this) - e; };
+            Vec2Array& operator += (Vec2D const &v) { return (*this) = (*this) + v; };
+            Vec2Array& operator -= (Vec2D const &v) { return (*this) = (*this) - v; };
+            Vec2Array& operator *= (float c) { return (*this) = (*this) * c; };
+
+            inline size_t size() const { return xs.size(); };
+            inline float x(size_t i) const { return xs[i]; };
+            inline float y(size_t i) const { return ys[i]; };
+
+            // * Pointers to the component arrays.
+            inline float* xData() { return xs.data(); };
+            inline float* yData() { return ys.data(); };
+            inline float const* xData() const { return xs.data(); };
+            inline float const* yData() const { return ys.data(); };
+
+            inline Vec2D get(size_t i) const { return Vec2D(xs[i], ys[i]); };
+
+            inline void set(size_t i, Vec2D const &v) {
+                xs[i] = v.x;
+                ys[i] = v.y;
+            };
+
+            inline void push(Vec2D const &v) {
+                xs.push_back(v.x);
+                ys.push_back(v.y);
+            };
+
+            inline void resize(size_t n) {
+                xs.resize(n);
+                ys.resize(n);
+            };
+
+            inline void reserve(size_t n) {
+                xs.reserve(n);
+                ys.reserve(n);
+            };
+
+            inline void clear() {
+                xs.clear();
+                ys.clear();
+            };
+    };
+
+
+    // * ============================================
+    // * Reductions
+    // * ============================================
+
+    // * Sum of the squared distances from every element to a point.
+    template <typename E>
+    inline float sumDistSq(Vec2Expr<E> const &e, Vec2D const &p) {
+        return ZMATH_DISPATCH_CALL(Detail::sumDistSq, e.self(), p, e.size());
+    };
+
+    // * Smallest squared distance from any element to a point. Infinity if the expression is empty.
+    template <typename E>
+    inline float minDistSq(Vec2Expr<E> const &e, Vec2D const &p) {
+        return ZMATH_DISPATCH_CALL(Detail::minDistSq, e.self(), p, e.size());
+    };
+
+    // * Index of the element closest to a point. Returns the size of the array if it is empty.
+    inline size_t nearest(Vec2Array const &a, Vec2D const &p) {
+        float min = minDistSq(a, p);
+
+        for (size_t i = 0; i < a.size(); ++i) {
+            float dx = a.x(i) - p.x, dy = a.y(i) - p.y;
+            if (dx*dx + dy*dy == min) { return i; }
+        }
+
+        return a.size();
+    };
+}
+
+#endif // !VEC2ARRAY_H
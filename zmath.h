@@ -1,7 +1,21 @@
 #ifndef ZMATH_H
 #define ZMATH_H
 
+#include <array>
+#include <bit>
 #include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+// * SSE2 backend for Vec2D and Mat2D.
+// * Define ZMATH_USE_SSE2 to enable it on targets that support SSE2; otherwise the scalar fallback is used.
+// * The scalar code is the default as GCC already vectorizes loops over it across objects, which the per-object
+// *  intrinsics prevent. Run `make bench` to compare the two on your machine.
+#if defined(ZMATH_USE_SSE2) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+    #define ZMATH_SSE2
+    #include <emmintrin.h>
+#endif
 
 namespace ZMath {
     // * =====================================
@@ -18,7 +32,215 @@ namespace ZMath {
     #define EPSILON 0.0005
 
     // * Get the sign of a number.
-    inline float signOf(float n) { return n < 0.0f ? -1.0f : 1.0f; };
+    constexpr float signOf(float n) { return n < 0.0f ? -1.0f : 1.0f; };
+
+    // * Get the absolute value of a float.
+    constexpr float abs(float n) { return n < 0.0f ? -n : n; };
+
+
+    // * =====================================
+    // * Compile-Time Math
+    // * =====================================
+
+    // ? libm functions cannot be called in constant expressions, so these series are used instead when ZMath is
+    // ?  evaluated at compile time. They are only meant for constant evaluation and tables; runtime code calls libm.
+
+    namespace CT {
+        constexpr double PI_D = 3.14159265358979323846;
+
+        // * Square root by Newton's method, starting above the root so the iterates decrease until they converge.
+        constexpr double sqrt(double n) {
+            if (n != n || n < 0.0) { return std::numeric_limits<double>::quiet_NaN(); }
+            if (n == 0.0 || n == std::numeric_limits<double>::infinity()) { return n; }
+
+            double x = n > 1.0 ? n : 1.0;
+
+            while (1) {
+                double next = 0.5 * (x + n/x);
+                if (next >= x) { return x; }
+                x = next;
+            }
+        };
+
+        // * Sine of an angle in radians by its Taylor series after reducing the angle to [-pi, pi].
+        constexpr double sin(double x) {
+            long long turns = (long long) (x / (2.0*PI_D));
+            x -= turns * 2.0*PI_D;
+            if (x > PI_D) { x -= 2.0*PI_D; }
+            if (x < -PI_D) { x += 2.0*PI_D; }
+
+            double term = x, sum = x;
+            for (int i = 1; i < 20; ++i) {
+                term *= -x*x / ((2*i) * (2*i + 1));
+                sum += term;
+            }
+
+            return sum;
+        };
+
+        // * Cosine of an angle in radians.
+        constexpr double cos(double x) { return sin(x + 0.5*PI_D); };
+
+        // * Sine of a whole number of degrees in [0, 360).
+        // * Uses symmetry so multiples of 90 degrees come out exact.
+        constexpr double sinDeg(int deg) {
+            if (deg > 180) { return -sinDeg(deg - 180); }
+            if (deg > 90) { deg = 180 - deg; }
+            return deg ? sin(deg * PI_D / 180.0) : 0.0;
+        };
+
+        constexpr std::array<float, 450> makeSinTable() {
+            std::array<float, 450> table{};
+            for (int i = 0; i < 450; ++i) { table[i] = (float) sinDeg(i % 360); }
+            return table;
+        };
+
+        // * sin of every whole degree from 0 to 449, so cos(d) = SIN_TABLE[d + 90] for d in [0, 360).
+        inline constexpr std::array<float, 450> SIN_TABLE = makeSinTable();
+
+        // * Is the angle a whole number of degrees small enough to index the table with.
+        constexpr bool isWholeDegree(float deg) { return deg > -16777216.0f && deg < 16777216.0f && deg == (float) (long) deg; };
+
+        // * Wrap a whole number of degrees into [0, 360).
+        constexpr int wrapDegree(long deg) {
+            int d = (int) (deg % 360);
+            return d < 0 ? d + 360 : d;
+        };
+    }
+
+    // * =====================================
+    // * Fast Approximations
+    // * =====================================
+
+    // ? Cheaper stand-ins for libm where a few ulps of error do not matter (collision normals, aiming, rendering).
+    // ? They are plain float arithmetic so they can be constant evaluated, vectorize in loops, and give the same
+    // ?  results on every CPU, unlike the rsqrtps instruction whose precision varies between vendors.
+    // ? The bounds below are the maximum errors measured against double precision libm by `make bench`.
+    // ? Define ZMATH_FAST_MATH to route Vec2D/Vec3D mag, normalize, and angle and the fractional-degree rotation builders
+    // ?  through these instead of libm.
+
+    namespace Fast {
+        /**
+         * @brief Reciprocal square root from a bit-level initial guess refined by two Newton steps.
+         *        Relative error at most 4.8e-6 for normal, positive floats. rsqrt(0) is about 2e19 rather than infinity.
+         */
+        constexpr float rsqrt(float n) {
+            float y = std::bit_cast<float>(0x5f375a86u - (std::bit_cast<uint32_t>(n) >> 1));
+            float h = 0.5f*n;
+
+            y *= 1.5f - h*y*y;
+            y *= 1.5f - h*y*y;
+            return y;
+        };
+
+        // * Square root as n * rsqrt(n). Relative error at most 4.8e-6 for normal, positive floats; sqrt(0) is 0.
+        constexpr float sqrt(float n) { return n*rsqrt(n); };
+
+        // * Sine of an angle in radians in [-pi, pi], folded into [-pi/2, pi/2] and evaluated with a degree 11 polynomial.
+        constexpr float sinReduced(float r) {
+            const float HALF_PI = 1.57079632679489662f;
+            const float PI_F = 3.14159265358979324f;
+
+            if (r > HALF_PI) { r = PI_F - r; }
+            if (r < -HALF_PI) { r = -PI_F - r; }
+
+            float r2 = r*r;
+            return r*(1.0f + r2*(-1.0f/6.0f + r2*(1.0f/120.0f + r2*(-1.0f/5040.0f + r2*(1.0f/362880.0f + r2*(-1.0f/39916800.0f))))));
+        };
+
+        // * Round to the nearest whole number. Only valid for |n| < 2^31.
+        constexpr float roundWhole(float n) { return (float) (int) (n + (n < 0.0f ? -0.5f : 0.5f)); };
+
+        // * Reduce an angle in radians to [-pi, pi]. 2pi is split in two so k * 2pi stays exact for |x| < 2e5.
+        constexpr float reduce(float x) {
+            float k = roundWhole(x * 0.159154943091895336f);
+            return (x - k*6.28125f) - k*0.00193530717958647692f;
+        };
+
+        // * Sine of an angle in radians. Absolute error at most 2.3e-7 for |x| <= 1000.
+        constexpr float sin(float x) { return sinReduced(reduce(x)); };
+
+        // * Cosine of an angle in radians. Absolute error at most 2.3e-7 for |x| <= 1000.
+        constexpr float cos(float x) { return sinReduced(1.57079632679489662f - abs(reduce(x))); };
+
+        // * Sine of an angle in degrees. The reduction to [-180, 180] is exact. Absolute error at most 2.5e-7.
+        constexpr float sinDeg(float deg) {
+            float r = deg - 360.0f*roundWhole(deg * (1.0f/360.0f));
+            return sinReduced(r * 0.0174532925199432958f);
+        };
+
+        // * Cosine of an angle in degrees. The reduction to [-180, 180] is exact. Absolute error at most 2.5e-7.
+        constexpr float cosDeg(float deg) {
+            float r = deg - 360.0f*roundWhole(deg * (1.0f/360.0f));
+            return sinReduced((90.0f - abs(r)) * 0.0174532925199432958f);
+        };
+
+        /**
+         * @brief Arccosine in radians using the degree 7 polynomial from Abramowitz and Stegun (4.4.46).
+         *        Absolute error at most 7.5e-6. Inputs are clamped to [-1, 1], so rounding past 1 gives 0 rather than NaN.
+         */
+        constexpr float acos(float x) {
+            x = x > 1.0f ? 1.0f : (x < -1.0f ? -1.0f : x);
+            float a = abs(x);
+
+            float p = 1.5707963050f + a*(-0.2145988016f + a*(0.0889789874f + a*(-0.0501743046f + a*(0.0308918810f
+                      + a*(-0.0170881256f + a*(0.0066700901f + a*-0.0012624911f))))));
+
+            float r = sqrt(1.0f - a) * p;
+            return x < 0.0f ? 3.14159265358979324f - r : r;
+        };
+    }
+
+    // * Square root that can be used in constant expressions. Calls sqrtf at runtime.
+    constexpr float sqrt(float n) {
+        if (std::is_constant_evaluated()) { return (float) CT::sqrt(n); }
+        return sqrtf(n);
+    };
+
+    // * Convert an angle in degrees to radians.
+    constexpr float toRadians(float degrees) { return (degrees/180) * PI; };
+
+    // * Sine of an angle in degrees.
+    // * Whole degrees are read from a table generated at compile time, so rotations by common wall angles do no trig.
+    constexpr float sinDeg(float theta) {
+        if (CT::isWholeDegree(theta)) { return CT::SIN_TABLE[CT::wrapDegree((long) theta)]; }
+        if (std::is_constant_evaluated()) { return (float) CT::sin(theta * CT::PI_D / 180.0); }
+
+        #ifdef ZMATH_FAST_MATH
+            return Fast::sinDeg(theta);
+        #else
+            return sinf(toRadians(theta));
+        #endif
+    };
+
+    // * Cosine of an angle in degrees.
+    // * Whole degrees are read from a table generated at compile time, so rotations by common wall angles do no trig.
+    constexpr float cosDeg(float theta) {
+        if (CT::isWholeDegree(theta)) { return CT::SIN_TABLE[CT::wrapDegree((long) theta) + 90]; }
+        if (std::is_constant_evaluated()) { return (float) CT::cos(theta * CT::PI_D / 180.0); }
+
+        #ifdef ZMATH_FAST_MATH
+            return Fast::cosDeg(theta);
+        #else
+            return cosf(toRadians(theta));
+        #endif
+    };
+
+    #ifdef ZMATH_SSE2
+        namespace SSE {
+            // Load two floats into the low lanes of a register. The high lanes are zeroed.
+            inline __m128 load2(const float* p) { return _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(p))); };
+
+            // Store the two low lanes of a register.
+            inline void store2(float* p, __m128 v) { _mm_store_sd(reinterpret_cast<double*>(p), _mm_castps_pd(v)); };
+
+            // Sum of the two low lanes, broadcast to every lane. Adds lane 0 to lane 1 in the same order as the scalar code.
+            inline __m128 hadd2(__m128 v) {
+                __m128 s = _mm_add_ss(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+                return _mm_shuffle_ps(s, s, 0);
+            };
+        }
+    #endif
 
 
     // * Class modeling a 2D Vector.
@@ -36,130 +258,197 @@ namespace ZMath {
             // * ============================
 
             // * Instantiate a Vec2D object with all components set to 0.
-            Vec2D() : x(0), y(0) {};
+            constexpr Vec2D() : x(0), y(0) {};
 
             // * Instantiate a Vec2D object with all components set to the same value.
-            Vec2D(float d) : x(d), y(d) {};
+            constexpr Vec2D(float d) : x(d), y(d) {};
 
             // * Instantiate a Vec3D object with each component assigned.
-            Vec2D(float i, float j) : x(i), y(j) {};
+            constexpr Vec2D(float i, float j) : x(i), y(j) {};
 
-            // * Instantiate a copy of the Vec3D object passed in.
-            Vec2D(const Vec2D &vec) : x(vec.x), y(vec.y) {};
+            // * Copies are left to the compiler so Vec2D stays trivially copyable.
 
             // * ============================
             // * Functions
             // * ============================
 
             // * Zero this vector.
-            void zero() {
+            constexpr void zero() {
                 x = 0;
                 y = 0;
             };
 
             // * Set this vector's components equal to another.
-            void set (Vec2D const &vec) {
+            constexpr void set (Vec2D const &vec) {
                 this->x = vec.x;
                 this->y = vec.y;
             };
 
             // * Set all components of this vector to the same value.
-            void set (float d) {
+            constexpr void set (float d) {
                 x = d;
                 y = d;
             };
 
             // * Set each component of this vector.
             // * Less expensive than creating a new Vec3D object.
-            void set (float i, float j) {
+            constexpr void set (float i, float j) {
                 x = i;
                 y = j;
             };
 
-            inline Vec2D operator + (Vec2D const &vec) const { return Vec2D(x + vec.x, y + vec.y); };
-            inline Vec2D operator - (Vec2D const &vec) const { return Vec2D(x - vec.x, y - vec.y); };
-            inline Vec2D operator * (float c) const { return Vec2D(c*x, c*y); };
-            inline float operator * (Vec2D const &vec) const { return x * vec.x + y * vec.y; };
+            #ifdef ZMATH_SSE2
+                // * Load this vector into the low lanes of an SSE register.
+                inline __m128 sse() const { return SSE::load2(&x); };
 
-            // * Add a constant to each vector component.
-            inline Vec2D operator + (float c) const { return Vec2D(x + c, y + c); };
+                // * Create a vector from the low lanes of an SSE register.
+                static inline Vec2D fromSSE(__m128 v) {
+                    Vec2D vec;
+                    SSE::store2(&vec.x, v);
+                    return vec;
+                };
+            #endif
 
-            inline bool operator != (Vec2D const &vec) const { return x != vec.x || y != vec.y; };
-            inline bool operator == (Vec2D const &vec) const { return x == vec.x && y == vec.y; };
+            // ? With the SSE2 backend, operators take the SSE path at runtime and the scalar path in constant expressions.
 
-            Vec2D& operator += (Vec2D const &vec) {
-                x += vec.x;
-                y += vec.y;
+            constexpr Vec2D operator + (Vec2D const &vec) const {
+                #ifdef ZMATH_SSE2
+                    if (!std::is_constant_evaluated()) { return fromSSE(_mm_add_ps(sse(), vec.sse())); }
+                #endif
+
+                return Vec2D(x + vec.x, y + vec.y);
+            };
+
+            constexpr Vec2D operator - (Vec2D const &vec) const {
+                #ifdef ZMATH_SSE2
+                    if (!std::is_constant_evaluated()) { return fromSSE(_mm_sub_ps(sse(), vec.sse())); }
+                #endif
 
+                return Vec2D(x - vec.x, y - vec.y);
+            };
+
+            constexpr Vec2D operator * (float c) const {
+                #ifdef ZMATH_SSE2
+                    if (!std::is_constant_evaluated()) { return fromSSE(_mm_mul_ps(_mm_set1_ps(c), sse())); }
+                #endif
+
+                return Vec2D(c*x, c*y);
+            };
+
+            constexpr float operator * (Vec2D const &vec) const { return x * vec.x + y * vec.y; };
+
+            // * Add a constant to each vector component.
+            constexpr Vec2D operator + (float c) const { return Vec2D(x + c, y + c); };
+
+            constexpr bool operator != (Vec2D const &vec) const { return x != vec.x || y != vec.y; };
+            constexpr bool operator == (Vec2D const &vec) const { return x == vec.x && y == vec.y; };
+
+            constexpr Vec2D& operator += (Vec2D const &vec) {
+                (*this) = (*this) + vec;
                 return (*this);
             };
 
-            Vec2D& operator += (float c) {
+            constexpr Vec2D& operator += (float c) {
                 x += c;
                 y += c;
 
                 return (*this);
             };
 
-            Vec2D& operator -= (Vec2D const &vec) {
-                x -= vec.x;
-                y -= vec.y;
-
+            constexpr Vec2D& operator -= (Vec2D const &vec) {
+                (*this) = (*this) - vec;
                 return (*this);
             };
 
-            Vec2D& operator -= (float c) {
+            constexpr Vec2D& operator -= (float c) {
                 x -= c;
                 y -= c;
 
                 return (*this);
             };
 
-            Vec2D& operator *= (float c) {
-                x *= c;
-                y *= c;
-
+            constexpr Vec2D& operator *= (float c) {
+                (*this) = (*this) * c;
                 return (*this);
             };
 
-            inline Vec2D operator - () const { return Vec2D(-x, -y); };
+            constexpr Vec2D operator - () const { return Vec2D(-x, -y); };
 
             // * Get the cross product of this and another vector.
-            inline Vec2D cross (Vec2D const &vec) const { return x*vec.y - y*vec.x; };
+            constexpr Vec2D cross (Vec2D const &vec) const { return x*vec.y - y*vec.x; };
 
             // * Get the magnitude.
-            inline float mag() const { return sqrtf(x*x + y*y); };
+            constexpr float mag() const {
+                #ifdef ZMATH_FAST_MATH
+                    return Fast::sqrt(x*x + y*y);
+                #else
+                    return ZMath::sqrt(x*x + y*y);
+                #endif
+            };
 
             // * Get the magnitude squared.
             // * This should be used over mag() when possible as it is less expensive.
-            inline float magSq() const { return x*x + y*y; };
+            constexpr float magSq() const { return x*x + y*y; };
 
             // * Get the vector projection of another vector onto this vector (Parameter onto this).
-            inline Vec2D proj (Vec2D const &vec) const { return (*this) * ((x*vec.x + y*vec.y)/(x*x + y*y)); };
+            constexpr Vec2D proj (Vec2D const &vec) const { return (*this) * ((x*vec.x + y*vec.y)/(x*x + y*y)); };
+
+            // * Reflect this vector about a surface with the given normalized normal, as a velocity bouncing off it.
+            constexpr Vec2D reflect (Vec2D const &normal) const { return (*this) - normal * (2.0f*(x*normal.x + y*normal.y)); };
 
             // * Get the distance between this and another vector.
-            inline float dist (Vec2D const &vec) const { return sqrtf((x - vec.x) * (x - vec.x) + (y - vec.y) * (y - vec.y)); };
+            constexpr float dist (Vec2D const &vec) const { return ZMath::sqrt((x - vec.x) * (x - vec.x) + (y - vec.y) * (y - vec.y)); };
 
             // * Get the distance squared between this and another vector.
             // * This should be used over dist() when possible as it is less expensive.
-            inline float distSq (Vec2D const &vec) const { return (x - vec.x) * (x - vec.x) + (y - vec.y) * (y - vec.y); };
+            constexpr float distSq (Vec2D const &vec) const {
+                #ifdef ZMATH_SSE2
+                    if (!std::is_constant_evaluated()) {
+                        __m128 d = _mm_sub_ps(sse(), vec.sse());
+                        return _mm_cvtss_f32(SSE::hadd2(_mm_mul_ps(d, d)));
+                    }
+                #endif
+
+                return (x - vec.x) * (x - vec.x) + (y - vec.y) * (y - vec.y);
+            };
 
             // * Get the normal vector. This is used to determine the direction a vector is pointing in.
-            inline Vec2D normalize() const { return (*this) * (1.0f/sqrtf(x*x + y*y)); };
+            constexpr Vec2D normalize() const {
+                #ifdef ZMATH_FAST_MATH
+                    return (*this) * Fast::rsqrt(x*x + y*y);
+                #endif
+
+                #ifdef ZMATH_SSE2
+                    if (!std::is_constant_evaluated()) {
+                        __m128 v = sse();
+                        __m128 m = SSE::hadd2(_mm_mul_ps(v, v));
+                        __m128 inv = _mm_div_ss(_mm_set_ss(1.0f), _mm_sqrt_ss(m));
+                        return fromSSE(_mm_mul_ps(_mm_shuffle_ps(inv, inv, 0), v));
+                    }
+                #endif
+
+                return (*this) * (1.0f/ZMath::sqrt(x*x + y*y));
+            };
 
             // * Get the angle between the vectors in radians.
             // * Keep in mind range restrictions for arccos.
             // * This function is very expensive. Only call if absolutely needed.
-            inline float angle (Vec2D const &vec) const { return acos((x*vec.x + y*vec.y)/(sqrtf(x*x + y*y) * sqrtf(vec.x*vec.x + vec.y*vec.y))); };
+            inline float angle (Vec2D const &vec) const {
+                #ifdef ZMATH_FAST_MATH
+                    return Fast::acos((x*vec.x + y*vec.y) * Fast::rsqrt(x*x + y*y) * Fast::rsqrt(vec.x*vec.x + vec.y*vec.y));
+                #else
+                    return acos((x*vec.x + y*vec.y)/(sqrtf(x*x + y*y) * sqrtf(vec.x*vec.x + vec.y*vec.y)));
+                #endif
+            };
 
             // * Get the value of cos^2(theta) between the vectors.
-            inline float cos2Ang (Vec2D const &vec) const {
+            constexpr float cos2Ang (Vec2D const &vec) const {
                 float d = x*vec.x + y*vec.y;
                 return (d*d)/((x*x + y*y)*(vec.x*vec.x + vec.y*vec.y));
             };
 
             // * Get the sign of each entry.
-            inline Vec2D getSigns() const { return Vec2D(signOf(x), signOf(y)); };
+            constexpr Vec2D getSigns() const { return Vec2D(signOf(x), signOf(y)); };
     };
 
 
@@ -178,37 +467,36 @@ namespace ZMath {
             // * ============================
 
             // * Instantiate a Vec3D object with all components set to 0.
-            Vec3D() : x(0), y(0), z(0) {};
+            constexpr Vec3D() : x(0), y(0), z(0) {};
 
             // * Instantiate a Vec3D object with all components set to the same value.
-            Vec3D(float d) : x(d), y(d), z(d) {};
+            constexpr Vec3D(float d) : x(d), y(d), z(d) {};
 
             // * Instantiate a Vec3D object with each component assigned.
-            Vec3D(float i, float j, float k) : x(i), y(j), z(k) {};
+            constexpr Vec3D(float i, float j, float k) : x(i), y(j), z(k) {};
 
-            // * Instantiate a copy of the Vec3D object passed in.
-            Vec3D(const Vec3D &vec) : x(vec.x), y(vec.y), z(vec.z) {};
+            // * Copies are left to the compiler so Vec3D stays trivially copyable.
 
             // * ============================
             // * Functions
             // * ============================
 
             // * Zero this vector.
-            void zero() {
+            constexpr void zero() {
                 x = 0;
                 y = 0;
                 z = 0;
             };
 
             // * Set this vector's components equal to another.
-            void set (Vec3D const &vec) {
+            constexpr void set (Vec3D const &vec) {
                 this->x = vec.x;
                 this->y = vec.y;
                 this->z = vec.z;
             };
 
             // * Set all components of this vector to the same value.
-            void set (float d) {
+            constexpr void set (float d) {
                 x = d;
                 y = d;
                 z = d;
@@ -216,25 +504,25 @@ namespace ZMath {
 
             // * Set each component of this vector.
             // * Less expensive than creating a new Vec3D object.
-            void set (float i, float j, float k) {
+            constexpr void set (float i, float j, float k) {
                 x = i;
                 y = j;
                 z = k;
             };
 
-            inline Vec3D operator + (Vec3D const &vec) const { return Vec3D(x + vec.x, y + vec.y, z + vec.z); };
-            inline Vec3D operator - (Vec3D const &vec) const { return Vec3D(x - vec.x, y - vec.y, z - vec.z); };
-            inline Vec3D operator * (float c) const { return Vec3D(c*x, c*y, c*z); };
-            inline float operator * (Vec3D const &vec) const { return x * vec.x + y * vec.y + z * vec.z; };
+            constexpr Vec3D operator + (Vec3D const &vec) const { return Vec3D(x + vec.x, y + vec.y, z + vec.z); };
+            constexpr Vec3D operator - (Vec3D const &vec) const { return Vec3D(x - vec.x, y - vec.y, z - vec.z); };
+            constexpr Vec3D operator * (float c) const { return Vec3D(c*x, c*y, c*z); };
+            constexpr float operator * (Vec3D const &vec) const { return x * vec.x + y * vec.y + z * vec.z; };
 
             // * Add a constant to each vector component.
-            inline Vec3D operator + (float c) const { return Vec3D(x + c, y + c, z + c); };
-            inline Vec3D operator - (float c) const { return Vec3D(x - c, y - c, z - c); };
+            constexpr Vec3D operator + (float c) const { return Vec3D(x + c, y + c, z + c); };
+            constexpr Vec3D operator - (float c) const { return Vec3D(x - c, y - c, z - c); };
 
-            inline bool operator != (Vec3D const &vec) const { return x != vec.x || y != vec.y || z != vec.z; };
-            inline bool operator == (Vec3D const &vec) const { return x == vec.x && y == vec.y && z == vec.z; };
+            constexpr bool operator != (Vec3D const &vec) const { return x != vec.x || y != vec.y || z != vec.z; };
+            constexpr bool operator == (Vec3D const &vec) const { return x == vec.x && y == vec.y && z == vec.z; };
 
-            Vec3D& operator += (Vec3D const &vec) {
+            constexpr Vec3D& operator += (Vec3D const &vec) {
                 x += vec.x;
                 y += vec.y;
                 z += vec.z;
@@ -242,7 +530,7 @@ namespace ZMath {
                 return (*this);
             };
 
-            Vec3D& operator += (float c) {
+            constexpr Vec3D& operator += (float c) {
                 x += c;
                 y += c;
                 z += c;
@@ -250,7 +538,7 @@ namespace ZMath {
                 return (*this);
             };
 
-            Vec3D& operator -= (Vec3D const &vec) {
+            constexpr Vec3D& operator -= (Vec3D const &vec) {
                 x -= vec.x;
                 y -= vec.y;
                 z -= vec.z;
@@ -258,7 +546,7 @@ namespace ZMath {
                 return (*this);
             };
 
-            Vec3D& operator -= (float c) {
+            constexpr Vec3D& operator -= (float c) {
                 x -= c;
                 y -= c;
                 z -= c;
@@ -266,7 +554,7 @@ namespace ZMath {
                 return (*this);
             };
 
-            Vec3D& operator *= (float c) {
+            constexpr Vec3D& operator *= (float c) {
                 x *= c;
                 y *= c;
                 z *= c;
@@ -274,44 +562,62 @@ namespace ZMath {
                 return (*this);
             };
 
-            inline Vec3D operator - () const { return Vec3D(-x, -y, -z); };
+            constexpr Vec3D operator - () const { return Vec3D(-x, -y, -z); };
 
             // * Get the cross product of this and another vector.
-            inline Vec3D cross (Vec3D const &vec) const { return Vec3D(y*vec.z - z*vec.y, -(x*vec.z - z*vec.x), x*vec.y - y*vec.x); };
+            constexpr Vec3D cross (Vec3D const &vec) const { return Vec3D(y*vec.z - z*vec.y, -(x*vec.z - z*vec.x), x*vec.y - y*vec.x); };
 
             // * Get the magnitude.
-            inline float mag() const { return sqrtf(x*x + y*y + z*z); };
+            constexpr float mag() const {
+                #ifdef ZMATH_FAST_MATH
+                    return Fast::sqrt(x*x + y*y + z*z);
+                #else
+                    return ZMath::sqrt(x*x + y*y + z*z);
+                #endif
+            };
 
             // * Get the magnitude squared.
             // * This should be used over mag() when possible as it is less expensive.
-            inline float magSq() const { return x*x + y*y + z*z; };
+            constexpr float magSq() const { return x*x + y*y + z*z; };
 
             // * Get the vector projection of another vector onto this vector (Parameter onto this).
-            inline Vec3D proj (Vec3D const &vec) const { return (*this) * ((x*vec.x + y*vec.y + z*vec.z)/(x*x + y*y + z*z)); };
+            constexpr Vec3D proj (Vec3D const &vec) const { return (*this) * ((x*vec.x + y*vec.y + z*vec.z)/(x*x + y*y + z*z)); };
 
             // * Get the distance between this and another vector.
-            inline float dist (Vec3D const &vec) const { return sqrtf((x - vec.x) * (x - vec.x) + (y - vec.y) * (y - vec.y) + (z - vec.z) * (z - vec.z)); };
+            constexpr float dist (Vec3D const &vec) const { return ZMath::sqrt((x - vec.x) * (x - vec.x) + (y - vec.y) * (y - vec.y) + (z - vec.z) * (z - vec.z)); };
 
             // * Get the distance squared between this and another vector.
             // * This should be used over dist() when possible as it is less expensive.
-            inline float distSq (Vec3D const &vec) const { return (x - vec.x) * (x - vec.x) + (y - vec.y) * (y - vec.y) + (z - vec.z) * (z - vec.z); };
+            constexpr float distSq (Vec3D const &vec) const { return (x - vec.x) * (x - vec.x) + (y - vec.y) * (y - vec.y) + (z - vec.z) * (z - vec.z); };
 
             // * Get the normal vector. This is used to determine the direction a vector is pointing in.
-            inline Vec3D normalize() const { return (*this) * (1.0f/sqrtf(x*x + y*y + z*z)); };
+            constexpr Vec3D normalize() const {
+                #ifdef ZMATH_FAST_MATH
+                    return (*this) * Fast::rsqrt(x*x + y*y + z*z);
+                #else
+                    return (*this) * (1.0f/ZMath::sqrt(x*x + y*y + z*z));
+                #endif
+            };
 
             // * Get the angle between the vectors in radians.
             // * Keep in mind range restrictions for arccos.
             // * This function is very expensive. Only call if absolutely needed.
-            inline float angle (Vec3D const &vec) const { return acos((x*vec.x + y*vec.y + z*vec.z)/(sqrtf(x*x + y*y + z*z) * sqrtf(vec.x*vec.x + vec.y*vec.y + vec.z*vec.z))); };
+            inline float angle (Vec3D const &vec) const {
+                #ifdef ZMATH_FAST_MATH
+                    return Fast::acos((x*vec.x + y*vec.y + z*vec.z) * Fast::rsqrt(x*x + y*y + z*z) * Fast::rsqrt(vec.x*vec.x + vec.y*vec.y + vec.z*vec.z));
+                #else
+                    return acos((x*vec.x + y*vec.y + z*vec.z)/(sqrtf(x*x + y*y + z*z) * sqrtf(vec.x*vec.x + vec.y*vec.y + vec.z*vec.z)));
+                #endif
+            };
 
             // * Get the value of cos^2(theta) between the vectors.
-            inline float cos2Ang (Vec3D const &vec) const {
+            constexpr float cos2Ang (Vec3D const &vec) const {
                 float d = x*vec.x + y*vec.y + z*vec.z;
                 return (d*d)/((x*x + y*y + z*z)*(vec.x*vec.x + vec.y*vec.y + vec.z*vec.z));
             };
 
             // * Get a vector with the sign of each entry.
-            inline Vec3D getSigns() const { return Vec3D(signOf(x), signOf(y), signOf(z)); };
+            constexpr Vec3D getSigns() const { return Vec3D(signOf(x), signOf(y), signOf(z)); };
     };
 
 
@@ -320,30 +626,27 @@ namespace ZMath {
     // * ============================================
 
     // * Get the absolute value of all components in a 2D vector.
-    inline Vec2D abs(const Vec2D &vec) { return Vec2D(std::fabs(vec.x), std::fabs(vec.y)); };
+    constexpr Vec2D abs(const Vec2D &vec) { return Vec2D(abs(vec.x), abs(vec.y)); };
 
     // * Get the absolute value of all components in a 3D vector.
-    inline Vec3D abs(const Vec3D &vec) { return Vec3D(std::fabs(vec.x), std::fabs(vec.y), std::fabs(vec.z)); };
+    constexpr Vec3D abs(const Vec3D &vec) { return Vec3D(abs(vec.x), abs(vec.y), abs(vec.z)); };
 
     // * Get the max value of two floats.
-    inline float max(float a, float b) { return a > b ? a : b; };
+    constexpr float max(float a, float b) { return a > b ? a : b; };
 
     // * Get the min value of two floats.
-    inline float min(float a, float b) { return a < b ? a : b; };
-
-    // * Convert an angle in degrees to radians.
-    inline float toRadians(float degrees) { return (degrees/180) * PI; };
+    constexpr float min(float a, float b) { return a < b ? a : b; };
 
     // * @brief Rotate a point in 3D space with respect to the XY-plane about an origin.
     // * 
     // * @param point The point in 3D space to rotate.
     // * @param origin The origin the point will be rotated about.
     // * @param angle The angle, in degrees, to rotate the point by.
-    inline void rotateXY(Vec3D &point, const Vec3D &origin, float angle) {
+    constexpr void rotateXY(Vec3D &point, const Vec3D &origin, float angle) {
         float x = point.x - origin.x, y = point.y - origin.y;
 
-        float cosine = cosf(toRadians(angle));
-        float sine = sinf(toRadians(angle));
+        float cosine = cosDeg(angle);
+        float sine = sinDeg(angle);
 
         // compute the new point -- z component is unchanged
         point.x = x*cosine - y*sine + origin.x;
@@ -355,11 +658,11 @@ namespace ZMath {
     // * @param point The point in 3D space to rotate.
     // * @param origin The origin the point will be rotated about.
     // * @param angle The angle, in degrees, to rotate the point by.
-    inline void rotateXZ(Vec3D &point, const Vec3D &origin, float angle) {
+    constexpr void rotateXZ(Vec3D &point, const Vec3D &origin, float angle) {
         float x = point.x - origin.x, z = point.z - origin.z;
 
-        float cosine = cosf(toRadians(angle));
-        float sine = sinf(toRadians(angle));
+        float cosine = cosDeg(angle);
+        float sine = sinDeg(angle);
 
         // compute the new point -- y component is unchanged
         point.x = x*cosine - z*sine + origin.x;
@@ -368,22 +671,22 @@ namespace ZMath {
 
     // * Handle tolerance for floating point numbers.
     // * If no epsilon is specified, the default of 5 * 10^-4 will be used.
-    inline bool compare(float a, float b, float epsilon = EPSILON) { return std::fabs(a - b) <= epsilon; };
+    constexpr bool compare(float a, float b, float epsilon = EPSILON) { return abs(a - b) <= epsilon; };
 
     // * Handler tolerance for 3D vectors of floating point numbers.
     // * If no epsilon is specified, the default of 5 * 10^-4 will be used.
-    inline bool compare(Vec3D u, Vec3D v, float epsilon = EPSILON) { return std::fabs(u.x - v.x) <= epsilon && std::fabs(u.y - v.y) <= epsilon && std::fabs(u.z - v.z) <= epsilon; };
+    constexpr bool compare(Vec3D u, Vec3D v, float epsilon = EPSILON) { return abs(u.x - v.x) <= epsilon && abs(u.y - v.y) <= epsilon && abs(u.z - v.z) <= epsilon; };
 
     // * Clamp a float between a min and max.
-    inline float clamp(float n, float min, float max) { return ZMath::max(ZMath::min(n, max), min); };
+    constexpr float clamp(float n, float min, float max) { return ZMath::max(ZMath::min(n, max), min); };
 
     // * Clamp a Vec2D between a min and max vector.
-    inline Vec2D clamp(const Vec2D &n, const Vec2D &min, const Vec2D &max) {
+    constexpr Vec2D clamp(const Vec2D &n, const Vec2D &min, const Vec2D &max) {
         return Vec2D(ZMath::max(ZMath::min(n.x, max.x), min.x), ZMath::max(ZMath::min(n.y, max.y), min.y));
     };
 
     // * Clamp a Vec3D between a min and max vector.
-    inline Vec3D clamp(const Vec3D &n, const Vec3D &min, const Vec3D &max) {
+    constexpr Vec3D clamp(const Vec3D &n, const Vec3D &min, const Vec3D &max) {
         return Vec3D(clamp(n.x, min.x, max.x), clamp(n.y, min.y, max.y), clamp(n.z, min.z, max.z));
     };
 
@@ -397,48 +700,40 @@ namespace ZMath {
             // Does nothing (for performance).
             Mat2D() = default;
 
-            // Create a 2D matrix from another 2D matrix.
-            Mat2D (const Mat2D &mat) {
-                c1.x = mat.c1.x;
-                c1.y = mat.c1.y;
-                c2.x = mat.c2.x;
-                c2.y = mat.c2.y;
-            };
+            // Copies are left to the compiler so Mat2D stays trivially copyable.
 
             // Create a 2D matrix from 2 column vectors.
-            Mat2D (const Vec2D &col1, const Vec2D &col2) {
-                c1.x = col1.x;
-                c1.y = col1.y;
-                c2.x = col2.x;
-                c2.y = col2.y;
-            };
+            constexpr Mat2D (const Vec2D &col1, const Vec2D &col2) : c1(col1), c2(col2) {};
 
             // Create a 2D matrix from 4 scalars.
-            Mat2D (float a11, float a12, float a21, float a22) {
-                c1.x = a11;
-                c1.y = a21;
-                c2.x = a12;
-                c2.y = a22;
-            };
+            constexpr Mat2D (float a11, float a12, float a21, float a22) : c1(a11, a21), c2(a12, a22) {};
+
+            #ifdef ZMATH_SSE2
+                // Load this matrix into an SSE register as (c1.x, c1.y, c2.x, c2.y).
+                inline __m128 sse() const { return _mm_loadu_ps(&c1.x); };
+
+                // Create a matrix from an SSE register laid out as (c1.x, c1.y, c2.x, c2.y).
+                static inline Mat2D fromSSE(__m128 v) {
+                    Mat2D mat;
+                    _mm_storeu_ps(&mat.c1.x, v);
+                    return mat;
+                };
+            #endif
 
             // Set this matrix's components equal to that of another.
-            void set (const Mat2D &mat) {
-                c1.x = mat.c1.x;
-                c1.y = mat.c1.y;
-                c2.x = mat.c2.x;
-                c2.y = mat.c2.y;
+            constexpr void set (const Mat2D &mat) {
+                c1 = mat.c1;
+                c2 = mat.c2;
             };
 
             // Set this matrix's columns equal to those passed in.
-            void set (const Vec2D &col1, const Vec2D &col2) {
-                c1.x = col1.x;
-                c1.y = col1.y;
-                c2.x = col2.x;
-                c2.y = col2.y;
+            constexpr void set (const Vec2D &col1, const Vec2D &col2) {
+                c1 = col1;
+                c2 = col2;
             };
 
             // Set this matrix's elements equal to those passed in.
-            void set(float a11, float a12, float a21, float a22) {
+            constexpr void set(float a11, float a12, float a21, float a22) {
                 c1.x = a11;
                 c1.y = a21;
                 c2.x = a12;
@@ -446,105 +741,139 @@ namespace ZMath {
             };
 
             // Set all elements equal to 0.
-            void zero() {
+            constexpr void zero() {
                 c1.x = 0;
                 c1.y = 0;
                 c2.x = 0;
                 c2.y = 0;
             };
 
-            inline Mat2D operator + (const Mat2D &mat) const { return Mat2D(c1 + mat.c1, c2 + mat.c2); };
-            inline Mat2D operator - (const Mat2D &mat) const { return Mat2D(c1 - mat.c1, c2 - mat.c2); };
-            inline Mat2D operator * (const Mat2D &mat) const {
+            constexpr Mat2D operator + (const Mat2D &mat) const {
+                #ifdef ZMATH_SSE2
+                    if (!std::is_constant_evaluated()) { return fromSSE(_mm_add_ps(sse(), mat.sse())); }
+                #endif
+
+                return Mat2D(c1 + mat.c1, c2 + mat.c2);
+            };
+
+            constexpr Mat2D operator - (const Mat2D &mat) const {
+                #ifdef ZMATH_SSE2
+                    if (!std::is_constant_evaluated()) { return fromSSE(_mm_sub_ps(sse(), mat.sse())); }
+                #endif
+
+                return Mat2D(c1 - mat.c1, c2 - mat.c2);
+            };
+
+            constexpr Mat2D operator * (const Mat2D &mat) const {
+                #ifdef ZMATH_SSE2
+                    if (!std::is_constant_evaluated()) {
+                        // each column of the product is this * the matching column of mat.
+                        __m128 a = sse(), b = mat.sse();
+                        __m128 lo = _mm_movelh_ps(a, a); // (c1.x, c1.y, c1.x, c1.y)
+                        __m128 hi = _mm_movehl_ps(a, a); // (c2.x, c2.y, c2.x, c2.y)
+                        __m128 bx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 2, 0, 0)); // (mat.c1.x, mat.c1.x, mat.c2.x, mat.c2.x)
+                        __m128 by = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 3, 1, 1)); // (mat.c1.y, mat.c1.y, mat.c2.y, mat.c2.y)
+
+                        return fromSSE(_mm_add_ps(_mm_mul_ps(lo, bx), _mm_mul_ps(hi, by)));
+                    }
+                #endif
+
                 return Mat2D(
-                    c1.x*mat.c1.x + c1.x*mat.c1.y, c1.x*mat.c2.x + c2.x*mat.c2.y,
+                    c1.x*mat.c1.x + c2.x*mat.c1.y, c1.x*mat.c2.x + c2.x*mat.c2.y,
                     c1.y*mat.c1.x + c2.y*mat.c1.y, c1.y*mat.c2.x + c2.y*mat.c2.y
                 );
             };
 
-            inline Mat2D operator * (float c) const { return Mat2D(c1*c, c2*c); };
-            inline Vec2D operator * (const Vec2D &vec) const { return Vec2D(c1.x*vec.x + c2.x*vec.y, c1.y*vec.x + c2.y*vec.y); };
-            inline Mat2D operator + (float c) const { return Mat2D(c1 + c, c2 + c); };
-            inline Mat2D operator - (float c) const { return Mat2D(c1 - c, c2 - c); };
+            constexpr Mat2D operator * (float c) const {
+                #ifdef ZMATH_SSE2
+                    if (!std::is_constant_evaluated()) { return fromSSE(_mm_mul_ps(sse(), _mm_set1_ps(c))); }
+                #endif
 
-            Mat2D& operator += (const Mat2D &mat) {
-                c1.x += mat.c1.x;
-                c1.y += mat.c1.y;
-                c2.x += mat.c2.x;
-                c2.y += mat.c2.y;
+                return Mat2D(c1*c, c2*c);
+            };
 
-                return (*this);
+            constexpr Vec2D operator * (const Vec2D &vec) const {
+                #ifdef ZMATH_SSE2
+                    if (!std::is_constant_evaluated()) {
+                        // (c1.x*x, c1.y*x, c2.x*y, c2.y*y) then add the halves.
+                        __m128 v = _mm_shuffle_ps(vec.sse(), vec.sse(), _MM_SHUFFLE(1, 1, 0, 0));
+                        __m128 p = _mm_mul_ps(sse(), v);
+                        return Vec2D::fromSSE(_mm_add_ps(p, _mm_movehl_ps(p, p)));
+                    }
+                #endif
+
+                return Vec2D(c1.x*vec.x + c2.x*vec.y, c1.y*vec.x + c2.y*vec.y);
             };
 
-            Mat2D& operator += (float c) {
-                c1.x += c;
-                c1.y += c;
-                c2.x += c;
-                c2.y += c;
+            constexpr Mat2D operator + (float c) const { return Mat2D(c1 + c, c2 + c); };
+            constexpr Mat2D operator - (float c) const { return Mat2D(c1 - c, c2 - c); };
 
+            constexpr Mat2D& operator += (const Mat2D &mat) {
+                (*this) = (*this) + mat;
                 return (*this);
             };
 
-            Mat2D& operator -= (const Mat2D &mat) {
-                c1.x -= mat.c1.x;
-                c1.y -= mat.c1.y;
-                c2.x -= mat.c2.x;
-                c2.y -= mat.c2.y;
-
+            constexpr Mat2D& operator += (float c) {
+                (*this) = (*this) + c;
                 return (*this);
             };
 
-            Mat2D& operator -= (float c) {
-                c1.x -= c;
-                c1.y -= c;
-                c2.x -= c;
-                c2.y -= c;
-
+            constexpr Mat2D& operator -= (const Mat2D &mat) {
+                (*this) = (*this) - mat;
                 return (*this);
             };
 
-            Mat2D& operator *= (const Mat2D &mat) {
-                c1.x = c1.x * mat.c1.x + c2.x * mat.c1.y;
-                c1.y = c1.x * mat.c2.x + c2.x * mat.c2.y;
-                c2.x = c1.y * mat.c1.x + c2.y * mat.c1.y;
-                c2.y = c1.y * mat.c2.x + c2.y * mat.c2.y;
-
+            constexpr Mat2D& operator -= (float c) {
+                (*this) = (*this) - c;
                 return (*this);
             };
 
-            Mat2D& operator *= (float c) {
-                c1.x *= c;
-                c1.y *= c;
-                c2.x *= c;
-                c2.y *= c;
+            constexpr Mat2D& operator *= (const Mat2D &mat) {
+                (*this) = (*this) * mat;
+                return (*this);
+            };
 
+            constexpr Mat2D& operator *= (float c) {
+                (*this) = (*this) * c;
                 return (*this);
             };
 
-            inline Mat2D operator - () const { return Mat2D(-c1, -c2); };
+            constexpr Mat2D operator - () const { return Mat2D(-c1, -c2); };
 
-            inline bool operator == (const Mat2D &mat) const { return c1.x == mat.c1.x && c1.y == mat.c1.y && c2.x == mat.c2.x && c2.y == mat.c2.y; };
-            inline bool operator != (const Mat2D &mat) const { return c1.x != mat.c1.x || c1.y != mat.c1.y || c2.x != mat.c2.x || c2.y != mat.c2.y; };
+            constexpr bool operator == (const Mat2D &mat) const { return c1.x == mat.c1.x && c1.y == mat.c1.y && c2.x == mat.c2.x && c2.y == mat.c2.y; };
+            constexpr bool operator != (const Mat2D &mat) const { return c1.x != mat.c1.x || c1.y != mat.c1.y || c2.x != mat.c2.x || c2.y != mat.c2.y; };
 
             // Return the inverse of this matrix.
             // Note this may experience issues for matrices with determinants nearly equal to 0.
-            inline Mat2D inverse() const {
+            constexpr Mat2D inverse() const {
                 float det = c1.x * c2.y - c2.x * c1.y;
-                Mat2D mat(*this);
 
-                if (compare(det, 0)) { return mat; }; // singular matrix -- doesn't have an inverse.
+                if (compare(det, 0)) { return (*this); }; // singular matrix -- doesn't have an inverse.
 
                 det = 1.0f/det;
 
-                mat.set(c2.y * det, c2.x * -det, c1.x * -det, c1.x * det);
-                return mat;
+                #ifdef ZMATH_SSE2
+                    if (!std::is_constant_evaluated()) {
+                        // (c2.y, -c1.y, -c2.x, c1.x) * det
+                        __m128 m = _mm_shuffle_ps(sse(), sse(), _MM_SHUFFLE(0, 2, 1, 3));
+                        return fromSSE(_mm_mul_ps(m, _mm_setr_ps(det, -det, -det, det)));
+                    }
+                #endif
+
+                return Mat2D(c2.y * det, c2.x * -det, c1.y * -det, c1.x * det);
             };
 
             // Return the transpose of this matrix.
-            inline Mat2D transpose() const { return Mat2D(c1.x, c1.y, c2.x, c2.y); };
+            constexpr Mat2D transpose() const {
+                #ifdef ZMATH_SSE2
+                    if (!std::is_constant_evaluated()) { return fromSSE(_mm_shuffle_ps(sse(), sse(), _MM_SHUFFLE(3, 1, 2, 0))); }
+                #endif
+
+                return Mat2D(c1.x, c1.y, c2.x, c2.y);
+            };
 
             // Return a matrix with the sign of each entry.
-            inline Mat2D getSigns() const { return Mat2D(c1.getSigns(), c2.getSigns()); };
+            constexpr Mat2D getSigns() const { return Mat2D(c1.getSigns(), c2.getSigns()); };
 
 
             // * ===============================
@@ -552,18 +881,23 @@ namespace ZMath {
             // * ===============================
 
             // * Get the 2x2 identity matrix.
-            static Mat2D identity() { return Mat2D(1, 0, 0, 1); };
+            static constexpr Mat2D identity() { return Mat2D(1, 0, 0, 1); };
 
             // * Generate the 2D rotation matrix given a specified angle.
-            // * The angle should be in degrees.
-            static Mat2D rotationMat(float theta) {
-                float s = sinf(toRadians(theta));
-                float c = cosf(toRadians(theta));
+            // * The angle should be in degrees. Whole degrees use the compile-time sine table.
+            static constexpr Mat2D rotationMat(float theta) {
+                float s = sinDeg(theta);
+                float c = cosDeg(theta);
 
                 return Mat2D(c, -s, s, c);
             };
     };
 
+    static_assert(std::is_trivially_copyable<Vec2D>::value, "Vec2D must stay trivially copyable.");
+    static_assert(std::is_trivially_copyable<Mat2D>::value, "Mat2D must stay trivially copyable.");
+    static_assert(std::is_trivially_copyable<Vec3D>::value, "Vec3D must stay trivially copyable.");
+    static_assert(sizeof(Mat2D) == 4*sizeof(float), "Mat2D must be 4 packed floats for the SSE2 backend.");
+
 
     // * Class modeling a 3x3 Matrix stored in column major order.
     class Mat3D {
@@ -573,59 +907,54 @@ namespace ZMath {
             // Does nothing (for performance).
             Mat3D() = default;
 
-            // Create a 3D matrix from another 3D matrix.
-            Mat3D (const Mat3D &mat) {
-                c1.set(mat.c1);
-                c2.set(mat.c2);
-                c3.set(mat.c3);
-            };
+            // Copies are left to the compiler so Mat3D stays trivially copyable.
 
             // Create a 3D matrix from 2 column vectors.
-            Mat3D (const Vec3D &col1, const Vec3D &col2, const Vec3D &col3) {
+            constexpr Mat3D (const Vec3D &col1, const Vec3D &col2, const Vec3D &col3) {
                 c1.set(col1);
                 c2.set(col2);
                 c3.set(col3);
             };
 
             // Create a 3D matrix from 9 scalars.
-            Mat3D (float a11, float a12, float a13, float a21, float a22, float a23, float a31, float a32, float a33) {
+            constexpr Mat3D (float a11, float a12, float a13, float a21, float a22, float a23, float a31, float a32, float a33) {
                 c1.set(a11, a21, a31);
                 c2.set(a12, a22, a32);
                 c3.set(a13, a23, a33);
             };
 
             // Set this matrix's components equal to that of another.
-            void set (const Mat3D &mat) {
+            constexpr void set (const Mat3D &mat) {
                 c1.set(mat.c1);
                 c2.set(mat.c2);
                 c3.set(mat.c3);
             };
 
             // Set this matrix's columns equal to those passed in.
-            void set (const Vec3D &col1, const Vec3D &col2, const Vec3D &col3) {
+            constexpr void set (const Vec3D &col1, const Vec3D &col2, const Vec3D &col3) {
                 c1.set(col1);
                 c2.set(col2);
                 c3.set(col3);
             };
 
             // Set this matrix's elements equal to those passed in.
-            void set(float a11, float a12, float a13, float a21, float a22, float a23, float a31, float a32, float a33) {
+            constexpr void set(float a11, float a12, float a13, float a21, float a22, float a23, float a31, float a32, float a33) {
                 c1.set(a11, a21, a31);
                 c2.set(a12, a22, a32);
                 c3.set(a13, a23, a33);
             };
 
             // Set all elements equal to 0.
-            void zero() {
+            constexpr void zero() {
                 c1.zero();
                 c2.zero();
                 c3.zero();
             };
 
-            inline Mat3D operator + (const Mat3D &mat) const { return Mat3D(c1 + mat.c1, c2 + mat.c2, c3 + mat.c3); };
-            inline Mat3D operator - (const Mat3D &mat) const { return Mat3D(c1 - mat.c1, c2 - mat.c2, c3 - mat.c3); };
+            constexpr Mat3D operator + (const Mat3D &mat) const { return Mat3D(c1 + mat.c1, c2 + mat.c2, c3 + mat.c3); };
+            constexpr Mat3D operator - (const Mat3D &mat) const { return Mat3D(c1 - mat.c1, c2 - mat.c2, c3 - mat.c3); };
 
-            inline Mat3D operator * (const Mat3D &mat) const {
+            constexpr Mat3D operator * (const Mat3D &mat) const {
                 return Mat3D(
                     // row 1
                     c1.x*mat.c1.x + c2.x*mat.c1.y + c3.x*mat.c1.z,
@@ -644,9 +973,9 @@ namespace ZMath {
                 );
             };
 
-            inline Mat3D operator * (float c) const { return Mat3D(c1*c, c2*c, c3*c); };
+            constexpr Mat3D operator * (float c) const { return Mat3D(c1*c, c2*c, c3*c); };
 
-            inline Vec3D operator * (const Vec3D &vec) const {
+            constexpr Vec3D operator * (const Vec3D &vec) const {
                 return Vec3D(
                     c1.x*vec.x + c2.x*vec.y + c3.x*vec.z,
                     c1.y*vec.x + c2.y*vec.y + c3.y*vec.z,
@@ -654,10 +983,10 @@ namespace ZMath {
                 );
             };
 
-            inline Mat3D operator + (float c) const { return Mat3D(c1 + c, c2 + c, c3 + c); };
-            inline Mat3D operator - (float c) const { return Mat3D(c1 - c, c2 - c, c3 - c); };
+            constexpr Mat3D operator + (float c) const { return Mat3D(c1 + c, c2 + c, c3 + c); };
+            constexpr Mat3D operator - (float c) const { return Mat3D(c1 - c, c2 - c, c3 - c); };
 
-            Mat3D& operator += (const Mat3D &mat) {
+            constexpr Mat3D& operator += (const Mat3D &mat) {
                 c1.x += mat.c1.x;
                 c1.y += mat.c1.y;
                 c1.z += mat.c1.z;
@@ -671,7 +1000,7 @@ namespace ZMath {
                 return (*this);
             };
 
-            Mat3D& operator += (float c) {
+            constexpr Mat3D& operator += (float c) {
                 c1.x += c;
                 c1.y += c;
                 c1.z += c;
@@ -685,7 +1014,7 @@ namespace ZMath {
                 return (*this);
             };
 
-            Mat3D& operator -= (const Mat3D &mat) {
+            constexpr Mat3D& operator -= (const Mat3D &mat) {
                 c1.x -= mat.c1.x;
                 c1.y -= mat.c1.y;
                 c1.z -= mat.c1.z;
@@ -699,7 +1028,7 @@ namespace ZMath {
                 return (*this);
             };
 
-            Mat3D& operator -= (float c) {
+            constexpr Mat3D& operator -= (float c) {
                 c1.x -= c;
                 c1.y -= c;
                 c1.z -= c;
@@ -713,26 +1042,12 @@ namespace ZMath {
                 return (*this);
             };
 
-            Mat3D& operator *= (const Mat3D &mat) {
-                // row 1
-                c1.x = c1.x*mat.c1.x + c2.x*mat.c1.y + c3.x*mat.c1.z;
-                c2.x = c1.x*mat.c2.x + c2.x*mat.c2.y + c3.x*mat.c2.z;
-                c3.x = c1.x*mat.c3.x + c2.x*mat.c3.y + c3.x*mat.c3.z;
-
-                // row 2
-                c1.y = c1.y*mat.c1.x + c2.y*mat.c1.y + c3.y*mat.c1.z;
-                c2.y = c1.y*mat.c2.x + c2.y*mat.c2.y + c3.y*mat.c2.z;
-                c3.y = c1.y*mat.c3.x + c2.y*mat.c3.y + c3.y*mat.c3.z;
-
-                // row 3
-                c1.z = c1.z*mat.c1.x + c2.z*mat.c1.y + c3.z*mat.c1.z;
-                c2.z = c1.z*mat.c2.x + c2.z*mat.c2.y + c3.z*mat.c2.z;
-                c3.z = c1.z*mat.c3.x + c2.z*mat.c3.y + c3.z*mat.c3.z;
-
+            constexpr Mat3D& operator *= (const Mat3D &mat) {
+                (*this) = (*this) * mat;
                 return (*this);
             };
 
-            Mat3D& operator *= (float c) {
+            constexpr Mat3D& operator *= (float c) {
                 c1.x *= c;
                 c1.y *= c;
                 c1.z *= c;
@@ -746,7 +1061,7 @@ namespace ZMath {
                 return (*this);
             };
 
-            Mat3D& operator - () {
+            constexpr Mat3D& operator - () {
                 c1.x = -c1.x;
                 c1.y = -c1.y;
                 c1.z = -c1.z;
@@ -760,26 +1075,26 @@ namespace ZMath {
                 return (*this);
             };
 
-            inline Mat3D operator - () const { return Mat3D(-c1, -c2, -c3); };
+            constexpr Mat3D operator - () const { return Mat3D(-c1, -c2, -c3); };
 
-            inline bool operator == (const Mat3D &mat) const {
+            constexpr bool operator == (const Mat3D &mat) const {
                 return c1.x == mat.c1.x && c1.y == mat.c1.y && c1.z == mat.c1.z &&
                         c2.x == mat.c2.x && c2.y == mat.c2.y && c2.z == mat.c2.z &&
                         c3.x == mat.c3.x && c3.y == mat.c3.y && c3.z == mat.c3.z;
             };
 
-            inline bool operator != (const Mat3D &mat) const {
+            constexpr bool operator != (const Mat3D &mat) const {
                 return c1.x != mat.c1.x || c1.y != mat.c1.y || c1.z != mat.c1.z ||
                         c2.x != mat.c2.x || c2.y != mat.c2.y || c2.z != mat.c2.z ||
                         c3.x != mat.c3.x || c3.y != mat.c3.y || c3.z != mat.c3.z;
             };
 
             // Return the transpose of this Matrix.
-            inline Mat3D transpose() const { return Mat3D(c1.x, c1.y, c1.z, c2.x, c2.y, c2.z, c3.x, c3.y, c3.z); };
+            constexpr Mat3D transpose() const { return Mat3D(c1.x, c1.y, c1.z, c2.x, c2.y, c2.z, c3.x, c3.y, c3.z); };
 
             // Return the inverse of this Matrix.
             // Note this may experience issues for matrices with determinants nearly equal to 0.
-            inline Mat3D inverse() const {
+            constexpr Mat3D inverse() const {
                 // for optimization
                 float qz = c2.y*c3.z;
                 float rx = c3.y*c1.z;
@@ -808,7 +1123,7 @@ namespace ZMath {
             };
 
             // Return a Mat3D with the signs of the entries.
-            inline Mat3D getSigns() const { return Mat3D(c1.getSigns(), c2.getSigns(), c3.getSigns()); };
+            constexpr Mat3D getSigns() const { return Mat3D(c1.getSigns(), c2.getSigns(), c3.getSigns()); };
 
 
             // * ===============================
@@ -816,14 +1131,14 @@ namespace ZMath {
             // * ===============================
 
             // * Get the 3x3 identity matrix.
-            static inline Mat3D identity() { return Mat3D(1, 0, 0, 0, 1, 0, 0, 0, 1); };
+            static constexpr Mat3D identity() { return Mat3D(1, 0, 0, 0, 1, 0, 0, 0, 1); };
 
             // * Generate the 3D rotation matrix about the x-axis for an angle, theta.
             // * Theta should be in degrees.
             // * Note: this rotates counter-clockwise about the axis.
-            static inline Mat3D rotationMatX(float theta) {
-                float c = cosf(toRadians(theta));
-                float s = sinf(toRadians(theta));
+            static constexpr Mat3D rotationMatX(float theta) {
+                float c = cosDeg(theta);
+                float s = sinDeg(theta);
 
                 return Mat3D(1, 0, 0, 0, c, -s, 0, s, c);
             };
@@ -831,9 +1146,9 @@ namespace ZMath {
             // * Generate the 3D rotation matrix about the y-axis for an angle, theta.
             // * Theta should be in degrees.
             // * Note: this rotates counter-clockwise about the axis.
-            static inline Mat3D rotationMatY(float theta) {
-                float c = cosf(toRadians(theta));
-                float s = sinf(toRadians(theta));
+            static constexpr Mat3D rotationMatY(float theta) {
+                float c = cosDeg(theta);
+                float s = sinDeg(theta);
 
                 return Mat3D(c, 0, s, 0, 1, 0, -s, 0, c);
             };
@@ -841,9 +1156,9 @@ namespace ZMath {
             // * Generate the 3D rotation matrix about the z-axis for an angle, theta.
             // * Theta should be in degrees.
             // * Note: this rotates counter-clockwise about the axis.
-            static inline Mat3D rotationMatZ(float theta) {
-                float c = cosf(toRadians(theta));
-                float s = sinf(toRadians(theta));
+            static constexpr Mat3D rotationMatZ(float theta) {
+                float c = cosDeg(theta);
+                float s = sinDeg(theta);
 
                 return Mat3D(c, -s, 0, s, c, 0, 0, 0, 1);
             };
@@ -856,22 +1171,24 @@ namespace ZMath {
              * @return (Mat3D) 3D rotation matrix that will rotate anything from global space into the object's local space.
              * Note: the transpose of this will rotate anything from local space into global space.
              */
-            static inline Mat3D generateRotationMatrix(float theta, float phi) { return rotationMatZ(theta) * rotationMatY(phi); };
+            static constexpr Mat3D generateRotationMatrix(float theta, float phi) { return rotationMatZ(theta) * rotationMatY(phi); };
     };
 
+    static_assert(std::is_trivially_copyable<Mat3D>::value, "Mat3D must stay trivially copyable.");
+
     // * ===================================
     // * Additional Utility Functions
     // * ===================================
 
     // * Take the absolute value of each element of a 2x2 matrix.
-    inline Mat2D abs(Mat2D const &mat) { return Mat2D(std::fabs(mat.c1.x), std::fabs(mat.c2.x), std::fabs(mat.c1.y), std::fabs(mat.c2.y)); };
+    constexpr Mat2D abs(Mat2D const &mat) { return Mat2D(abs(mat.c1.x), abs(mat.c2.x), abs(mat.c1.y), abs(mat.c2.y)); };
 
     // * Take the absolute value of each element of a 3x3 matrix.
-    inline Mat3D abs(Mat3D const &mat) {
+    constexpr Mat3D abs(Mat3D const &mat) {
         return Mat3D(
-            std::fabs(mat.c1.x), std::fabs(mat.c2.x), std::fabs(mat.c3.x),
-            std::fabs(mat.c1.y), std::fabs(mat.c2.y), std::fabs(mat.c3.y),
-            std::fabs(mat.c1.z), std::fabs(mat.c2.z), std::fabs(mat.c3.z)
+            abs(mat.c1.x), abs(mat.c2.x), abs(mat.c3.x),
+            abs(mat.c1.y), abs(mat.c2.y), abs(mat.c3.y),
+            abs(mat.c1.z), abs(mat.c2.z), abs(mat.c3.z)
         );
     };
 }